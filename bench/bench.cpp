@@ -0,0 +1,323 @@
+/*==============================================================================================
+    
+    bench.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Benchmark Harness
+    10/19/26 - B.D.S.
+    Purpose: Assembles a generated program and reports throughput as one line of JSON.
+    
+==============================================================================================*/
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "assembler.hpp"
+#include "generator.hpp"
+#include "lexer.hpp"
+#include "packer.hpp"
+#include "preprocessor.hpp"
+#include "stats.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+#define PACK_INPUT_SIZE (4 << 20) //bytes handed to the packer when -z is given
+#define LEX_PASSES      4         //times the source is lexed by each scan, the fastest is kept
+
+typedef chrono::steady_clock bench_clock;
+
+static double seconds_since(bench_clock::time_point start)
+{
+    return chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+//splits every line the way the preprocessor and assembler do, returns a sum so none of it is skipped
+static long long lex_source(const string &source)
+{
+    const char* text = source.data();
+    int length = source.length();
+    long long sum = 0;
+    
+    for (int from = 0; from < length; )
+    {
+        int end = lexer::find(text, from, length, '\n', '\n');
+        span line = lexer::source_line(text, from, end);
+        span mnem, arg1, arg2;
+        
+        lexer::split_instruction(text, line.start, line.start + line.length, mnem, arg1, arg2);
+        sum += mnem.length + arg1.start + arg2.length;
+        from = end + 1;
+    }
+    
+    return sum;
+}
+
+static long peak_rss_kb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024; //bytes on darwin, kilobytes everywhere else
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+    string tpl = "z80.tpl";
+    string dir = ".";
+    program_shape shape;
+    bench_clock::time_point start;
+    double phase_generate;
+    double phase_pack = 0;
+    int output_size = 0;
+    int pack_level = 0;
+    int packed_size = 0;
+    int lex_mb = 0;
+    int lex_size = 0;
+    double lex_seconds[LEX_AVX2+1] = { 0, 0, 0 };
+    bool success = true;
+    
+    shape.lines = 10000;
+    shape.depth = 4;
+    shape.fanout = 1;
+    shape.label_every = 16;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        
+        if (i+1 >= argc)
+            break;
+        
+        if (arg == "-t")
+            tpl = argv[++i];
+        else if (arg == "-w")      //directory the generated program is written to
+            dir = argv[++i];
+        else if (arg == "-n")      //instruction lines in the whole program
+            shape.lines = atoi(argv[++i]);
+        else if (arg == "-i")      //levels of #inject below the main file
+            shape.depth = atoi(argv[++i]);
+        else if (arg == "-f")      //files injected by each file
+            shape.fanout = atoi(argv[++i]);
+        else if (arg == "-l")      //instruction lines between labels
+            shape.label_every = atoi(argv[++i]);
+        else if (arg == "-z")      //also pack a few megabytes made from the output at this level
+            pack_level = atoi(argv[++i]);
+        else if (arg == "-x")      //also lex this many megabytes made from the generated source with every scan
+            lex_mb = atoi(argv[++i]);
+    }
+    
+    start = bench_clock::now();
+    generator* gr = new generator(tpl);
+    vector<string> files = gr->write_program(dir, shape);
+    phase_generate = seconds_since(start);
+    
+    if (gr->errors_exist)
+    {
+        cout << "Could not generate a program to benchmark." << endl;
+        delete gr;
+        return 1;
+    }
+    
+    stats::enabled = true;
+    preprocessor* pr;
+    assembler* ir;
+    
+    {
+        stat_timer timer(PHASE_PREPROCESS);
+        pr = new preprocessor(files[0]);
+        success = !pr->errors_exist;
+    }
+    
+    {
+        stat_timer timer(PHASE_ASSEMBLE);
+        ir = new assembler(files[0] + ".combined", tpl);
+        ir->take_label_table(&pr->labels);
+        ir->take_constants(&pr->constants);
+        ir->take_tokens(&pr->tokens);
+        
+        if (success)
+            ir->run();
+        
+        success = success && !ir->errors_exist;
+    }
+    
+    if (success)
+    {
+        stat_timer timer(PHASE_OUTPUT);
+        ir->export_to_file(files[0] + ".bin");
+        output_size = ir->output_size();
+        success = !ir->errors_exist;
+    }
+    
+    if (success && pack_level > 0)
+    {
+        ostringstream image;
+        string raw;
+        string input;
+        vector<uchar> packed;
+        packer pk(pack_level);
+        unsigned int seed = 1;
+        
+        ir->write_image(image);
+        raw = image.str();
+        input.reserve(PACK_INPUT_SIZE);
+        
+        //copies of the output with about one byte in 64 changed, so matches are common but not trivial
+        while (raw.length() > 0 && input.length() < PACK_INPUT_SIZE)
+        {
+            for (int i = 0; i < raw.length() && input.length() < PACK_INPUT_SIZE; i++)
+            {
+                seed = seed * 1103515245 + 12345;
+                input += ((seed >> 16) % 64 == 0) ? (char)(seed >> 24) : raw[i];
+            }
+        }
+        
+        start = bench_clock::now();
+        pk.pack((const uchar*)input.data(), input.length(), packed);
+        phase_pack = seconds_since(start);
+        packed_size = packed.size();
+    }
+    
+    if (success && lex_mb > 0)
+    {
+        string source;
+        string text;
+        int best = lexer::best_mode();
+        int line = 0;
+        
+        for (int i = 0; i < files.size(); i++)
+        {
+            ifstream file(files[i].c_str());
+            ostringstream contents;
+            contents << file.rdbuf();
+            text += contents.str();
+        }
+        
+        source.reserve((lex_mb << 20) + 256);
+        
+        //indented like hand written source, with a comment on every fourth line
+        for (int from = 0; text.length() > 0 && source.length() < (lex_mb << 20); line++)
+        {
+            int end = text.find('\n', from);
+            
+            if (end == string::npos)
+                end = text.length();
+            
+            source += "    ";
+            source.append(text, from, end - from);
+            source += (line % 4 == 0) ? "        //keeps the loop count in b\n" : "\n";
+            from = (end + 1 >= text.length()) ? 0 : end + 1;
+        }
+        
+        lex_size = source.length();
+        
+        for (int mode = LEX_SCALAR; mode <= best; mode++)
+        {
+            long long sum = 0;
+            lexer::set_mode(mode);
+            
+            for (int pass = 0; pass < LEX_PASSES; pass++)
+            {
+                start = bench_clock::now();
+                sum += lex_source(source);
+                double taken = seconds_since(start);
+                
+                if (pass == 0 || taken < lex_seconds[mode])
+                    lex_seconds[mode] = taken;
+            }
+            
+            if (sum == 0)
+                success = false;
+        }
+        
+        lexer::set_mode(best);
+    }
+    
+    double total = stats::seconds(PHASE_PREPROCESS) + stats::seconds(PHASE_ASSEMBLE) + stats::seconds(PHASE_OUTPUT);
+    long long lines = stats::counters[STAT_LINES]; //lines the assembler went through, not the number asked for
+    
+    cout << "{\"bench\": \"siasm\""
+         << ", \"success\": " << (success ? "true" : "false")
+         << ", \"lines\": " << lines
+         << ", \"requested_lines\": " << shape.lines
+         << ", \"files\": " << files.size()
+         << ", \"depth\": " << shape.depth
+         << ", \"fanout\": " << shape.fanout
+         << ", \"labels\": " << gr->labels_written()
+         << ", \"output_bytes\": " << output_size
+         << ", \"template_scans\": " << stats::counters[STAT_TEMPLATE_SCANS]
+         << ", \"exceptions\": " << stats::counters[STAT_EXCEPTIONS]
+         << ", \"cache_hits\": " << stats::counters[STAT_CACHE_HITS]
+         << ", \"seconds\": {"
+         << "\"generate\": " << phase_generate
+         << ", \"preprocess\": " << stats::seconds(PHASE_PREPROCESS)
+         << ", \"lookup\": " << stats::seconds(PHASE_LOOKUP)
+         << ", \"encode\": " << stats::seconds(PHASE_ENCODE)
+         << ", \"output\": " << stats::seconds(PHASE_OUTPUT)
+         << ", \"total\": " << total
+         << "}, \"lines_per_sec\": " << ((total > 0) ? lines / total : 0)
+         << ", \"peak_rss_kb\": " << peak_rss_kb();
+    
+    if (pack_level > 0)
+    {
+        cout << ", \"pack\": {\"level\": " << pack_level
+             << ", \"input_bytes\": " << ((packed_size > 0) ? PACK_INPUT_SIZE : 0)
+             << ", \"output_bytes\": " << packed_size
+             << ", \"seconds\": " << phase_pack
+             << ", \"mb_per_sec\": " << ((phase_pack > 0) ? PACK_INPUT_SIZE / 1048576.0 / phase_pack : 0) << "}";
+    }
+    
+    if (lex_mb > 0)
+    {
+        const char* names[LEX_AVX2+1] = { "scalar", "sse2", "avx2" };
+        
+        cout << ", \"lex\": {\"input_bytes\": " << lex_size;
+        
+        for (int mode = LEX_SCALAR; mode <= LEX_AVX2; mode++)
+        {
+            if (lex_seconds[mode] > 0)
+                cout << ", \"" << names[mode] << "_mb_per_sec\": " << lex_size / 1048576.0 / lex_seconds[mode];
+        }
+        
+        cout << ", \"speedup\": " << ((lex_seconds[lexer::best_mode()] > 0) ? lex_seconds[LEX_SCALAR] / lex_seconds[lexer::best_mode()] : 0) << "}";
+    }
+    
+    cout << "}" << endl;
+    
+    pr->cleanup();
+    delete ir;
+    delete pr;
+    delete gr;
+    return success ? 0 : 1;
+}
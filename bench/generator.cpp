@@ -0,0 +1,131 @@
+/*==============================================================================================
+    
+    generator.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "generator.hpp"
+#include <fstream>
+#include <iostream>
+
+generator::generator(string tplfile)
+{
+    disassembler* dr = new disassembler(tplfile);
+    const vector<template_row> &rows = dr->template_rows();
+    
+    errors_exist = dr->errors_exist;
+    label_count = 0;
+    
+    //every mnemonic and argument combination the template knows shows up in the program
+    for (int i = 0; i < rows.size(); i++)
+        instructions.push_back(dr->sample_instruction(rows[i]));
+    
+    if (instructions.size() == 0)
+        errors_exist = true;
+    
+    delete dr;
+}
+
+string generator::label_name(int number)
+{
+    string name = "lbl";
+    
+    do
+    {
+        name += (char)('a' + number % 26);
+        number /= 26;
+    }
+    while (number > 0);
+    
+    return name;
+}
+
+bool generator::write_file(string dir, int level, int lines_per_file)
+{
+    ofstream outstream;
+    string path = dir + "/" + ((files.size() == 0) ? string("bench_main.bda") : "bench_" + to_string(files.size()) + ".bda");
+    vector<int> inject_at; //instruction lines the children of this file are injected before
+    bool success = true;
+    
+    files.push_back(path);
+    
+    if (level < shape.depth)
+    {
+        for (int i = 0; i < shape.fanout; i++)
+            inject_at.push_back((lines_per_file * (i + 1)) / (shape.fanout + 1));
+    }
+    
+    outstream.open(path.c_str());
+    
+    if (!outstream.is_open())
+    {
+        cout << path << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    outstream << "//generated by siasm_bench" << endl;
+    
+    for (int i = 0, child = 0; i <= lines_per_file; i++)
+    {
+        //children are written depth first so their names are known before the #inject line
+        while (child < inject_at.size() && inject_at[child] == i && success)
+        {
+            outstream << "#inject <" << dir << "/bench_" << files.size() << ".bda>" << endl;
+            success = write_file(dir, level + 1, lines_per_file);
+            child++;
+        }
+        
+        if (i == lines_per_file)
+            break;
+        
+        if (shape.label_every > 0 && i % shape.label_every == 0)
+            outstream << '.' << label_name(label_count++) << endl;
+        
+        outstream << instructions[next_inst] << endl;
+        next_inst = (next_inst + 1) % instructions.size();
+    }
+    
+    outstream.close();
+    return success;
+}
+
+vector<string> generator::write_program(string dir, program_shape program)
+{
+    int file_count = 1;
+    int level_count = 1;
+    
+    shape = program;
+    files.clear();
+    next_inst = 0;
+    
+    if (shape.fanout < 1)
+        shape.fanout = 1;
+    
+    for (int i = 0; i < shape.depth; i++)
+    {
+        level_count *= shape.fanout;
+        file_count += level_count;
+    }
+    
+    //lines are spread evenly, so the program can come out a few lines short of what was asked
+    if (!write_file(dir, 0, shape.lines / file_count))
+        errors_exist = true;
+    
+    return files;
+}
@@ -0,0 +1,63 @@
+/*==============================================================================================
+    
+    generator.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Program Generator
+    10/19/26 - B.D.S.
+    Purpose: Writes large synthetic programs from the template file for benchmarking.
+    
+==============================================================================================*/
+
+#ifndef _GENERATOR_HPP
+#define _GENERATOR_HPP
+
+#include <string>
+#include <vector>
+#include "disassembler.hpp"
+using namespace std;
+
+struct program_shape
+{
+    int lines;       //instruction lines across every file of the program
+    int depth;       //levels of #inject below the main file
+    int fanout;      //files injected by every file above the deepest level
+    int label_every; //instruction lines between labels, zero for no labels
+};
+
+class generator
+{
+    vector<string> instructions;               //one line of source for every template row
+    vector<string> files;                      //every file of the program being written, main first
+    program_shape shape;                       //shape of the program being written
+    int label_count;                           //labels written so far, keeps names unique across files
+    int next_inst;                             //template row the next instruction line is taken from
+    
+    string label_name(int number);             //labels must be alphabetic so numbers are spelled in letters
+    bool write_file(string dir, int level, int lines_per_file);
+    
+    public:
+        bool errors_exist;
+        generator(string tplfile);
+        vector<string> write_program(string dir, program_shape shape); //returns every file written, main first
+        int labels_written() { return label_count; }
+};
+
+#endif
@@ -21,7 +21,18 @@
 ==============================================================================================*/
 
 #include "assembler.hpp"
+#include "expression.hpp"
+#include "lexer.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 struct instruction_not_found : public exception
 {
@@ -38,314 +49,1993 @@ struct corrupt_template : public exception
     const char* what() const throw() { return "template file corruption"; }
 };
 
+//argument classes as numbered in the template file, this table will need to change if you update it
+static const char* argument_table[ARG_TABLE_LENGTH] = {
+    "",     "N",  "NN",  "(NN)", "DIS", "$",
+    "b",    "c",  "bc",  "(bc)",
+    "d",    "e",  "de",  "(de)",
+    "h",    "l",  "hl",  "(hl)",
+    "a",    "af", "af'", "sp",
+    "(sp)", "i",  "r",   "(c)",
+    "nz",   "z",  "nc",  "po",
+    "pe",   "p",  "m",
+    "0",    "1",  "2",   "3",    "4",   "5",  "6", "7",
+    "8",    "16", "24",  "32",   "40",  "48", "56",
+    "ix",   "iy", "(ix)", "(iy)", "(ix+DIS)", "(iy+DIS)"
+};
+
+static map<string, string> template_cache; //every template read so far, they are small and scanned constantly
+
+//lines already encoded with each template, shared by every thread and every run of --watch
+static map<string, unordered_map<string, cached_encoding> > encoding_cache;
+static mutex encoding_lock;
+
+//fills stream with the template, only going to the file the first time it is asked for
+static bool load_template(string file, istringstream &stream)
+{
+    map<string, string>::iterator cached = template_cache.find(file);
+    
+    if (cached == template_cache.end())
+    {
+        ifstream tplstream;
+        ostringstream contents;
+        tplstream.open(file.c_str(), ios::binary|ios::in);
+        
+        if (!tplstream.is_open())
+            return false;
+        
+        contents << tplstream.rdbuf();
+        cached = template_cache.insert(make_pair(file, contents.str())).first;
+    }
+    
+    stream.str(cached->second);
+    return true;
+}
+
 assembler::assembler(string instfile, string tplfile)
 {
     byte_count = 0;
+    cycle_count = 0;
+    inst_cycles = 0;
+    tpl_inst_count = -1;
+    tpl_scans = 0;
+    quiet = false;
+    thread_count = 0;
+    entry_label = "";
+    relocatable = false;
+    operand_fixup = FIXUP_NONE;
+    operand_name = -1;
+    constants = NULL;
+    streaming = false;
+    spilled = 0;
+    started = false;
+    line_count = 0;
+    error_count = 0;
+    next_label_line = 0;
+    errors_exist = false;
+    start_address = 0;
+    crnt_section = 0;
+    
+    //everything before the first section line goes in main, starting at address zero unless there is an org
+    section main_section = { "main", 0, false };
+    sections.push_back(main_section);
+    start_region();
 
     filename_tpl = tplfile;
     filename_inst = instfile;
-    stream_tpl.open(filename_tpl.c_str(), ios::binary|ios::in);
+    tpl_open = load_template(tplfile, stream_tpl);
     stream_inst.open(filename_inst.c_str());
+    tokens = &batch;
+    tokens_read = false;
+    token_base = 0;
+}
+
+void assembler::take_tokens(const token_ir* lines)
+{
+    tokens = lines;
+}
+
+void assembler::set_threads(int count)
+{
+    thread_count = count;
+}
+
+void assembler::forget_template(string file)
+{
+    template_cache.erase(file);
+    
+    lock_guard<mutex> hold(encoding_lock);
+    encoding_cache.erase(file);
+}
+
+assembler::~assembler()
+{
+    for (int i = 0; i < binaries.size(); i++)
+        delete binaries[i];
+    
+    if (spill.is_open())
+    {
+        spill.close();
+        remove(spill_file.c_str());
+    }
 }
 
 void assembler::take_label_table(vector<label*>* table)
 {
     labels = *table;
+    label_sections.assign(labels.size(), 0);
+    label_bytes.assign(labels.size(), 0);
+    label_cycles.assign(labels.size(), 0);
+    symbols.clear();
+    
+    for (int i = 0; i < labels.size(); i++)
+    {
+        symbol_entry entry = { i, 0 };
+        symbols[labels[i]->name] = entry;
+    }
+}
+
+void assembler::take_constants(const expr_symbols* table)
+{
+    constants = table;
+    
+    for (expr_symbols::const_iterator c = table->begin(); c != table->end(); ++c)
+    {
+        symbol_entry entry = { -1, (int)c->second };
+        symbols[c->first] = entry;
+    }
+}
+
+//calls work for every chunk, spread over threads that each take the next chunk nobody has started
+static void for_each_chunk(int chunks, int threads, function<void(int chunk, int thread)> work)
+{
+    atomic<int> next(0);
+    vector<thread> pool;
+    auto worker = [&](int id) { for (int c = next++; c < chunks; c = next++) work(c, id); };
+    
+    for (int i = 1; i < threads; i++)
+        pool.push_back(thread(worker, i));
+    
+    worker(0);
+    
+    for (int i = 0; i < pool.size(); i++)
+        pool[i].join();
 }
 
 void assembler::run()
 {
-    int line_number = 0;
-    int error_count = 0;
-    int next_label_line = 0; //we wait until we get to a label so we can give it an accurate address
-    string instline;
+    if (!start())
+        return;
+    
+    //a single batch holds the whole program
+    while (error_count == 0 && read_lines())
+    {
+        if (!assemble_lines())
+            return;
+    }
+    
+    finish();
+}
+
+bool assembler::assemble_batch(const token_ir* lines, const vector<label*> &table, const expr_symbols &found)
+{
+    if (errors_exist || error_count != 0)
+        return false;
+    
+    add_labels(table);
+    take_constants(&found);
+    tokens = lines;
+    token_base = line_count;
+    
+    if (!started && !start())
+        return false;
+    
+    return assemble_lines() && error_count == 0;
+}
+
+void assembler::finish_batches()
+{
+    if (started && !errors_exist)
+        finish();
+}
+
+void assembler::add_labels(const vector<label*> &table)
+{
+    if (next_label_line == 0 && table.size() > labels.size()) //every label so far is placed, the next is the first new one
+        next_label_line = table[labels.size()]->line;
     
+    for (int i = labels.size(); i < table.size(); i++)
+    {
+        symbol_entry entry = { i, 0 };
+        labels.push_back(table[i]);
+        symbols.insert(make_pair(table[i]->name, entry)); //a constant of the same name was already reported
+    }
+    
+    label_sections.resize(labels.size(), 0);
+    label_bytes.resize(labels.size(), 0);
+    label_cycles.resize(labels.size(), 0);
+}
+
+bool assembler::start()
+{
     if (labels.size() > 0) //priming the system that resolves label addresses
         next_label_line = labels[0]->line;
     
-    if (stream_tpl.is_open() && stream_inst.is_open())
-    {	
-        if (!template_file_check())
+    if (!tpl_open || (tokens == &batch && !stream_inst.is_open()))
+    {
+        cout << "File(s) could not be opened to read!" << endl;
+        errors_exist = true;
+        stream_inst.close();
+        return false;
+    }
+    
+    if (!template_file_check())
+    {
+        stream_inst.close();
+        errors_exist = true;
+        return false;
+    }
+    
+    if (streaming)
+    {
+        spill_file = filename_inst + ".bytes";
+        spill.open(spill_file.c_str(), ios::binary|ios::in|ios::out|ios::trunc);
+        
+        if (!spill.is_open())
         {
-            stream_tpl.close();
+            cout << spill_file << " could not be opened to write!" << endl;
+            errors_exist = true;
             stream_inst.close();
-            return;
+            return false;
+        }
+    }
+    
+    started = true;
+    return true;
+}
+
+bool assembler::assemble_lines()
+{
+    int threads = (thread_count > 0) ? thread_count : max(1, (int)thread::hardware_concurrency());
+    int chunks = (tokens->size() + CHUNK_LINES - 1) / CHUNK_LINES;
+    int batch_threads = max(1, min(threads, chunks));
+    int code_bytes = 0;
+    vector<assembler*> encoders;
+    vector<vector<line_code> > codes(chunks);
+    vector<vector<uchar> > buffers(chunks);
+    
+    //each thread encodes with an assembler of its own, errors are left for the pass below to report in order
+    for (int i = 0; i < batch_threads; i++)
+    {
+        encoders.push_back(new assembler("", filename_tpl));
+        encoders.back()->quiet = true;
+        encoders.back()->take_label_table(&labels); //only read, to know which operands are labels
+        
+        if (constants != NULL)
+            encoders.back()->take_constants(constants);
+        
+        encoders.back()->relocatable = relocatable;
+        encoders.back()->streaming = streaming; //only to take names not known yet for labels
+    }
+    
+    //first pass: every instruction is encoded without knowing its address, which tells us its size
+    {
+        stat_timer timer(PHASE_ENCODE);
+        
+        for_each_chunk(chunks, batch_threads, [&](int chunk, int id) {
+            int from = chunk * CHUNK_LINES;
+            encode_chunk(encoders[id], from, min(tokens->size(), from + CHUNK_LINES), codes[chunk], buffers[chunk]);
+        });
+    }
+    
+    for (int i = 0; i < encoders.size(); i++)
+        delete encoders[i];
+    
+    if (entry_label != "" && !remove_unreachable(codes))
+    {
+        errors_exist = true;
+        return false;
+    }
+    
+    for (int i = 0; i < chunks; i++)
+        code_bytes += buffers[i].size();
+    
+    outbytes.reserve(outbytes.size() + code_bytes);
+    
+    //second pass, in order: directives, data, and labels, with each instruction given the next place in its section
+    for (int i = 0; i < tokens->size(); i++)
+    {
+        line_code &code = codes[i / CHUNK_LINES][i % CHUNK_LINES];
+        string mnemonic;
+        string argument1;
+        string argument2;
+        
+        line_count++;
+        
+        if (code.kind == LINE_EMPTY)
+        {
+            resolve_label_addresses(line_count, next_label_line); //labels of removed blocks still go by
+            continue;
         }
         
-        //begin reading user instructions
-        while (getline(stream_inst, instline))
+        stats::count(STAT_LINES);
+        
+        if (code.kind != LINE_CODE)
+            tokens->spell(i, mnemonic, argument1, argument2);
+        
+        if (code.kind == LINE_DIRECTIVE)
+            process_directive(error_count, line_count, mnemonic, argument1, argument2);
+        
+        resolve_label_addresses(line_count, next_label_line); //after directives so a label takes on a new org
+        
+        if (error_count != 0)
+            break;
+        
+        if (code.kind == LINE_DIRECTIVE)
+            continue;
+        
+        if (code.kind == LINE_DATA)
+        {
+            if (!process_data(error_count, line_count, mnemonic, argument1, argument2))
+                break;
+        }
+        else if (code.kind == LINE_BAD)
+        {
+            int first_byte = outbytes.size();
+            
+            if (!resolve_instruction(error_count, line_count, mnemonic, argument1, argument2)) //shows the error
+                break;
+            
+            cycle_count += inst_cycles;
+            
+            if (operand_fixup != FIXUP_NONE)
+                note_fixup(operand_fixup, first_byte, outbytes.size() - first_byte, -1, operand_symbol);
+        }
+        else
+        {
+            code.placed = outbytes.size();
+            outbytes.resize(outbytes.size() + code.length);
+            place_bytes(code.placed);
+            cycle_count += code.cycles;
+            
+            if (code.fixup != FIXUP_NONE)
+                note_fixup(code.fixup, code.placed, code.length, code.name, code.symbol);
+        }
+    }
+    
+    //third pass: instruction bytes go straight to their places, which no longer move
+    for_each_chunk((error_count == 0) ? chunks : 0, batch_threads, [&](int chunk, int) {
+        for (int i = 0; i < codes[chunk].size(); i++)
         {
-            string mnemonic;
-            string argument1;
-            string argument2;
+            const line_code &code = codes[chunk][i];
+            
+            if (code.kind == LINE_CODE && code.placed >= 0)
+                copy(buffers[chunk].begin() + code.first, buffers[chunk].begin() + code.first + code.length, outbytes.begin() + code.placed);
+        }
+    });
+    
+    if (streaming)
+        spill_bytes();
+    
+    return true;
+}
+
+void assembler::finish()
+{
+    stream_inst.close();
+    
+    //objects leave every symbol to the linker, even labels of their own, since their addresses can still move
+    if (error_count == 0 && !relocatable)
+        resolve_fixups(error_count);
+    
+    if (error_count == 0)
+        check_pages(error_count);
+    
+    if (error_count == 0)
+        check_budgets(error_count);
+    
+    if (error_count != 0)
+    {
+        cout << "Could not go further due to " << error_count << " error(s).";
+        errors_exist = true;
+    }
+    else if (!relocatable) //sections of an object that are not fixed all start at zero until they are linked
+        memory_map(true); //reports overlapping sections
+}
+
+bool assembler::read_lines()
+{
+    string instline;
+    
+    if (tokens != &batch)
+    {
+        bool first = !tokens_read;
+        tokens_read = true;
+        return first && tokens->size() > 0;
+    }
+    
+    token_base += batch.size();
+    batch.clear(); //names keep their ids from one batch to the next
+    
+    while (getline(stream_inst, instline))
+        batch.add_line(instline.data(), instline.length(), -1, 0);
+    
+    return batch.size() > 0;
+}
+
+void assembler::spill_bytes()
+{
+    string bytes(outbytes.begin(), outbytes.end());
+    
+    spill.seekp(spilled);
+    spill.write(bytes.data(), bytes.length());
+    spilled += outbytes.size();
+    outbytes.clear();
+}
+
+string assembler::stored_bytes(int first, int count)
+{
+    string bytes(count, '\0');
+    
+    if (!spill.is_open())
+        return string(outbytes.begin() + first, outbytes.begin() + first + count);
+    
+    spill.seekg(first);
+    spill.read(&bytes[0], count);
+    return bytes;
+}
+
+void assembler::patch_byte(int at, int value)
+{
+    if (at >= spilled)
+    {
+        outbytes[at - spilled] = value;
+        return;
+    }
+    
+    spill.seekp(at);
+    spill.put((char)value);
+}
 
-            line_number++;
+void assembler::encode_chunk(assembler* encoder, int from, int to, vector<line_code> &codes, vector<uchar> &buffer)
+{
+    vector<int> bytes;
+    
+    for (int i = from; i < to; i++)
+    {
+        line_code code = { LINE_EMPTY, (int)buffer.size(), 0, 0, -1, FIXUP_NONE, -1, "" };
+        int mnemonic = tokens->mnemonics[i];
+        
+        if (mnemonic >= 0)
+        {
+            //directives and data have fixed name ids, in that order
+            if (mnemonic <= NAME_ASSERT_SIZE)
+                code.kind = LINE_DIRECTIVE;
+            else if (mnemonic <= NAME_ALIGN)
+                code.kind = LINE_DATA;
+            else if (encoder->assemble_tokens(*tokens, i, bytes))
+            {
+                code.kind = LINE_CODE;
+                code.length = bytes.size();
+                code.cycles = encoder->inst_cycles;
+                code.fixup = encoder->operand_fixup;
+                code.name = encoder->operand_name;
+                
+                if (code.fixup != FIXUP_NONE && code.name < 0)
+                    code.symbol = encoder->operand_symbol;
+                
+                for (int j = 0; j < bytes.size(); j++)
+                    buffer.push_back(bytes[j]);
+            }
+            else
+                code.kind = LINE_BAD;
+        }
+        
+        codes.push_back(code);
+    }
+}
 
-            if (instline.length() == 0)
+bool assembler::remove_unreachable(vector<vector<line_code> > &codes)
+{
+    vector<int> starts;          //first line of each block, labels on the same line share one
+    vector<string> names;
+    map<string, int> block_of;
+    int removed_bytes = 0;
+    int removed_blocks = 0;
+    
+    for (int i = 0; i < labels.size(); i++)
+    {
+        if (starts.size() > 0 && starts.back() == labels[i]->line)
+            names.back() += "/" + labels[i]->name;
+        else
+        {
+            starts.push_back(labels[i]->line);
+            names.push_back(labels[i]->name);
+        }
+        
+        block_of[labels[i]->name] = starts.size(); //block zero is everything before the first label
+    }
+    
+    if (block_of.count(entry_label) == 0)
+    {
+        cout << "Entry label " << entry_label << " was not found!" << endl;
+        return false;
+    }
+    
+    vector<vector<int> > refs(starts.size() + 1);
+    vector<bool> falls(starts.size() + 1, true); //runs on into the next block, an empty block always does
+    vector<bool> reached(starts.size() + 1, false);
+    vector<int> pending;
+    
+    falls[0] = false; //only matters once there is code before the first label
+    
+    for (int i = 0; i < tokens->size(); i++)
+    {
+        const line_code &code = codes[i / CHUNK_LINES][i % CHUNK_LINES];
+        int block = upper_bound(starts.begin(), starts.end(), i + 1) - starts.begin();
+        string mnem, arg1, arg2;
+        string list;
+        
+        if (code.kind == LINE_EMPTY || code.kind == LINE_DIRECTIVE)
+            continue;
+        
+        tokens->spell(i, mnem, arg1, arg2);
+        list = (arg2 != "") ? arg1 + ',' + arg2 : arg1;
+        
+        //the last instruction decides whether the block can run on, data after it never runs
+        if (code.kind != LINE_DATA)
+            falls[block] = !((mnem == "ret" && arg1 == "") || mnem == "reti" || mnem == "retn"
+                             || ((mnem == "jp" || mnem == "jr") && arg1 != "" && arg2 == ""));
+        
+        //any operand naming a label keeps its block, calls and jumps as well as loads of its address
+        for (int start = 0, comma; start <= list.length(); start = comma + 1)
+        {
+            comma = list.find(',', start);
+            
+            if (comma == string::npos)
+                comma = list.length();
+            
+            string item = bs_util::trim(list.substr(start, comma - start));
+            
+            if (bs_util::is_pointer(item))
+                item = bs_util::remove_outer_chars(item);
+            
+            if (block_of.count(item) > 0)
+                refs[block].push_back(block_of[item]);
+        }
+    }
+    
+    pending.push_back(0);
+    pending.push_back(block_of[entry_label]);
+    
+    while (pending.size() > 0)
+    {
+        int block = pending.back();
+        pending.pop_back();
+        
+        if (reached[block])
+            continue;
+        
+        reached[block] = true;
+        pending.insert(pending.end(), refs[block].begin(), refs[block].end());
+        
+        if (falls[block] && block < starts.size())
+            pending.push_back(block + 1);
+    }
+    
+    //lines of blocks nothing reaches are emptied, but directives stay so the sections after them still line up
+    for (int block = 1; block <= starts.size(); block++)
+    {
+        int first = starts[block-1] - 1;
+        int last = (block < starts.size()) ? starts[block] - 1 : tokens->size();
+        int bytes = 0;
+        
+        if (reached[block])
+            continue;
+        
+        for (int i = first; i < last && i < tokens->size(); i++)
+        {
+            line_code &code = codes[i / CHUNK_LINES][i % CHUNK_LINES];
+            
+            if (code.kind == LINE_DIRECTIVE || code.kind == LINE_EMPTY)
                 continue;
+            
+            bytes += (code.kind == LINE_DATA) ? data_length(tokens->spell_line(i)) : code.length;
+            code.kind = LINE_EMPTY;
+        }
+        
+        cout << "Removed unreachable block " << names[block-1] << ", " << bytes << " bytes." << endl;
+        removed_bytes += bytes;
+        removed_blocks++;
+    }
+    
+    cout << "Removed " << removed_bytes << " bytes in " << removed_blocks << " blocks not reached from " << entry_label << "." << endl;
+    return true;
+}
 
-            read(instline, mnemonic, argument1, argument2);
+int assembler::data_length(string line)
+{
+    string mnem, arg1, arg2;
+    vector<string> items;
+    string list;
+    
+    read(line, mnem, arg1, arg2);
+    list = (arg2 != "") ? arg1 + ',' + arg2 : arg1;
+    
+    for (int start = 0, comma; start <= list.length(); start = comma + 1)
+    {
+        comma = list.find(',', start);
+        
+        if (comma == string::npos)
+            comma = list.length();
+        
+        items.push_back(bs_util::trim(list.substr(start, comma - start)));
+        substitute_constant(items.back());
+    }
+    
+    if (mnem == "db")
+        return items.size();
+    
+    if (mnem == "dw")
+        return items.size() * 2;
+    
+    if (mnem == "ds")
+        return max(0, atoi(items[0].c_str()));
+    
+    if (mnem == "dbtable" || mnem == "dwtable")
+        return max(0, atoi(items[1].c_str()) - atoi(items[0].c_str()) + 1) * ((mnem == "dwtable") ? 2 : 1);
+    
+    if (mnem == "align") //depends on where the block would have gone
+        return 0;
+    
+    if (items.size() > 2) //incbin with a length
+        return max(0, atoi(items[2].c_str()));
+    
+    mapped_file binary;
+    
+    if (items[0].length() < 3 || !binary.open(items[0].substr(1, items[0].length() - 2)))
+        return 0;
+    
+    return max(0, binary.size() - ((items.size() > 1) ? atoi(items[1].c_str()) : 0));
+}
 
-            resolve_label_addresses(line_number, next_label_line);
+void assembler::set_entry(string label_name)
+{
+    entry_label = label_name;
+}
 
-            if (!resolve_instruction(error_count, line_number, mnemonic, argument1, argument2))
-                break;
+bool assembler::is_symbol(string name)
+{
+    unordered_map<string, symbol_entry>::const_iterator found = symbols.find(name);
+    
+    if (found != symbols.end())
+        return found->second.label >= 0;
+    
+    //registers and conditions are never taken for symbols of other objects, or for labels further on in a stream,
+    //which resolve_fixups reports when they never turn up
+    return (relocatable || streaming) && bs_util::is_name(name) && table_of_arguments(name) < 0;
+}
+
+void assembler::set_relocatable(bool on)
+{
+    relocatable = on;
+}
+
+void assembler::set_streaming(bool on)
+{
+    streaming = on;
+}
+
+void assembler::note_fixup(int kind, int at, int length, int name, const string &symbol)
+{
+    fixup_site f = { kind, spilled + at + length - ((kind == FIXUP_WORD) ? 2 : 1), sections[crnt_section].address, name,
+                     (name < 0) ? symbol : "" };
+    
+    //called once the instruction is placed, so the section address is already past it
+    fixups.push_back(f);
+}
+
+const string &assembler::fixup_symbol(const fixup_site &f) const
+{
+    //names keep their ids from one batch to the next, so an id stays good until the tokens are gone
+    return (f.name >= 0) ? tokens->names[f.name] : f.symbol;
+}
+
+void assembler::resolve_fixups(int &error_amount)
+{
+    for (int i = 0; i < fixups.size(); i++)
+    {
+        const fixup_site &f = fixups[i];
+        int value;
+        
+        unordered_map<string, symbol_entry>::const_iterator found = symbols.find(fixup_symbol(f));
+        
+        //a constant streamed in after a line that uses it was taken for a label there
+        if (streaming && found != symbols.end() && found->second.label < 0)
+            value = found->second.value;
+        else if (found == symbols.end() || found->second.label < 0)
+        {
+            cout << "Assembly error, in " << filename_inst << " -> " << fixup_symbol(f) << " is not a label" << endl;
+            error_amount++;
+            continue;
+        }
+        else
+            value = labels[found->second.label]->value;
+        
+        if (f.kind == FIXUP_DISP)
+        {
+            value -= f.next;
+            
+            if (!bs_util::can_be_signed_one_byte_value(value))
+            {
+                cout << "Assembly error, in " << filename_inst << " -> " << fixup_symbol(f) << " is " << value << " bytes away, too far for a relative jump" << endl;
+                error_amount++;
+                continue;
+            }
+        }
+        
+        patch_byte(f.at, bs_util::num_get_lsb(value));
+        
+        if (f.kind == FIXUP_WORD)
+            patch_byte(f.at + 1, bs_util::num_get_msb(value));
+    }
+}
+
+bool assembler::export_object(string file)
+{
+    object_file obj;
+    vector<int> renumbered(regions.size(), -1); //regions without bytes are left out
+    
+    for (int i = 0; i < sections.size(); i++)
+    {
+        obj_section s = { sections[i].name, sections[i].fixed, sections[i].address };
+        obj.sections.push_back(s);
+    }
+    
+    for (int i = 0; i < regions.size(); i++)
+    {
+        obj_region r;
+        
+        if (regions[i].length == 0)
+            continue;
+        
+        r.section = regions[i].section;
+        r.address = regions[i].address;
+        
+        if (regions[i].data != NULL)
+            r.bytes.assign(regions[i].data, regions[i].data + regions[i].length);
+        else
+        {
+            string bytes = stored_bytes(regions[i].first, regions[i].length);
+            r.bytes.assign(bytes.begin(), bytes.end());
+        }
+        
+        renumbered[i] = obj.regions.size();
+        obj.regions.push_back(r);
+    }
+    
+    //every label is exported, what the fixups name beyond them is imported
+    for (int i = 0; i < labels.size(); i++)
+    {
+        obj_symbol s = { labels[i]->name, label_sections[i], labels[i]->value };
+        obj.add_symbol(s);
+    }
+    
+    for (int i = 0; i < fixups.size(); i++)
+    {
+        obj_fixup f = { fixups[i].kind, -1, 0, fixups[i].next, obj.symbol_index(fixup_symbol(fixups[i])) };
+        
+        for (int j = 0; j < regions.size() && f.region < 0; j++)
+        {
+            if (regions[j].data == NULL && fixups[i].at >= regions[j].first && fixups[i].at < regions[j].first + regions[j].length)
+            {
+                f.region = renumbered[j];
+                f.offset = fixups[i].at - regions[j].first;
+            }
+        }
+        
+        obj.fixups.push_back(f);
+    }
+    
+    //anything too long for its length byte or word would be written wrapped around, corrupting the object
+    for (int i = 0; i < obj.sections.size(); i++)
+    {
+        if (obj.sections[i].name.length() > OBJ_NAME_LIMIT)
+        {
+            cout << "Section " << obj.sections[i].name << " has a name longer than " << OBJ_NAME_LIMIT << " characters, which an object cannot hold!" << endl;
+            return false;
+        }
+    }
+    
+    for (int i = 0; i < obj.symbols.size(); i++)
+    {
+        if (obj.symbols[i].name.length() > OBJ_NAME_LIMIT)
+        {
+            cout << "Symbol " << obj.symbols[i].name << " has a name longer than " << OBJ_NAME_LIMIT << " characters, which an object cannot hold!" << endl;
+            return false;
+        }
+    }
+    
+    for (int i = 0; i < obj.regions.size(); i++)
+    {
+        if (obj.regions[i].bytes.size() > OBJ_WORD_LIMIT)
+        {
+            cout << "Section " << obj.sections[obj.regions[i].section].name << " has " << obj.regions[i].bytes.size() << " bytes from ";
+            cout << obj.regions[i].address << " in a row, more than the " << OBJ_WORD_LIMIT << " an object can hold!" << endl;
+            return false;
+        }
+    }
+    
+    return obj.write(file);
+}
+
+void assembler::add_bytes(string section_name, int address, const vector<uchar> &bytes)
+{
+    int found = -1;
+    
+    for (int i = 0; i < sections.size(); i++)
+    {
+        if (sections[i].name == section_name)
+            found = i;
+    }
+    
+    if (found < 0)
+    {
+        section new_section = { section_name, address, true };
+        sections.push_back(new_section);
+        found = sections.size() - 1;
+    }
+    
+    crnt_section = found;
+    sections[crnt_section].address = address;
+    start_region();
+    
+    int first_byte = outbytes.size();
+    outbytes.insert(outbytes.end(), bytes.begin(), bytes.end());
+    place_bytes(first_byte);
+}
+
+void assembler::display_results()
+{
+    for (int i = 0; i < regions.size(); i++)
+    {
+        string bytes = (regions[i].data != NULL) ? string((const char*)regions[i].data, regions[i].length)
+                     : stored_bytes(regions[i].first, regions[i].length);
+        
+        for (int j = 0; j < bytes.length(); j++)
+            cout << (int)(uchar)bytes[j] << endl;
+    }
+    
+    cout << "SUCCESS" << endl;
+    cout << endl << "Displaying label table: " << endl;
+    
+    for (int i = 0; i < labels.size(); i++)
+        cout << labels[i]->name << ", " << labels[i]->line << ", " << labels[i]->value << endl;
+    
+    cout << endl << "Displaying memory map: " << endl;
+    display_memory_map(cout);
+}
+
+void assembler::export_to_file(string file)
+{
+    ofstream outstream;
+    outstream.open(file.c_str(), ios::binary|ios::out);
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        errors_exist = true;
+        return;
+    }
+    
+    write_image(outstream);
+    outstream.close();
+}
+
+void assembler::write_image(ostream &out)
+{
+    vector<region> map = memory_map(false);
+    int address;
+    
+    //the image starts at the lowest populated address, gaps between regions are zero filled
+    if (map.size() > 0)
+        start_address = map[0].address;
+    
+    address = start_address;
+    
+    for (int i = 0; i < map.size(); i++)
+    {
+        if (map[i].address > address)
+            out << string(map[i].address - address, '\0');
+        
+        write_region(out, map[i], 0, map[i].length);
+        address = map[i].address + map[i].length;
+    }
+}
+
+int assembler::image_address()
+{
+    vector<region> map = memory_map(false);
+    return (map.size() > 0) ? map[0].address : 0;
+}
+
+vector<string> assembler::binary_files()
+{
+    vector<string> names;
+    
+    for (int i = 0; i < binaries.size(); i++)
+        names.push_back(binaries[i]->name());
+    
+    return names;
+}
+
+void assembler::populated_ranges(vector<int> &starts, vector<int> &lengths)
+{
+    vector<region> map = memory_map(false);
+    starts.clear();
+    lengths.clear();
+    
+    //regions that follow on from each other are one range
+    for (int i = 0; i < map.size(); i++)
+    {
+        if (starts.size() > 0 && map[i].address == starts.back() + lengths.back())
+        {
+            lengths.back() += map[i].length;
+        }
+        else
+        {
+            starts.push_back(map[i].address);
+            lengths.push_back(map[i].length);
+        }
+    }
+}
+
+void assembler::export_sparse(string file)
+{
+    ofstream outstream;
+    vector<region> map = memory_map(false);
+    const int BLOCK_LIMIT = 65535; //block lengths are two bytes, a full 64K run is split in two
+    outstream.open(file.c_str(), ios::binary|ios::out);
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        errors_exist = true;
+        return;
+    }
+    
+    //each block is its address and length, least significant byte first, followed by its bytes
+    for (int i = 0; i < map.size(); i++)
+    {
+        int first = i;
+        int address = map[i].address;
+        int length = map[i].length;
+        
+        //regions that follow on from each other are written as one block
+        while (i+1 < map.size() && map[i+1].address == map[i].address + map[i].length)
+            length += map[++i].length;
+        
+        for (int done = 0, r = first, from = 0; done < length; )
+        {
+            int count = min(length - done, BLOCK_LIMIT);
+            
+            outstream.put((char)bs_util::num_get_lsb(address + done));
+            outstream.put((char)bs_util::num_get_msb(address + done));
+            outstream.put((char)bs_util::num_get_lsb(count));
+            outstream.put((char)bs_util::num_get_msb(count));
+            done += count;
+            
+            while (count > 0)
+            {
+                int take = min(count, map[r].length - from);
+                write_region(outstream, map[r], from, take);
+                count -= take;
+                from += take;
+                
+                if (from == map[r].length)
+                {
+                    r++;
+                    from = 0;
+                }
+            }
+        }
+    }
+    
+    outstream << string(4, '\0'); //a block at address zero with no length ends the image
+    outstream.close();
+}
+
+void assembler::write_region(ostream &out, const region &r, int from, int count)
+{
+    string bytes;
+    
+    //incbin data goes straight from its mapping to the output
+    if (r.data != NULL)
+    {
+        out.write((const char*)r.data + from, count);
+        return;
+    }
+    
+    bytes = stored_bytes(r.first + from, count);
+    out.write(bytes.c_str(), bytes.length());
+}
+
+void assembler::display_memory_map(ostream &out)
+{
+    vector<region> map = memory_map(false);
+    
+    out << "section, start, end, bytes" << endl;
+    
+    for (int i = 0; i < map.size(); i++)
+    {
+        int address = map[i].address;
+        int length = map[i].length;
+        
+        //a section that was left and came back to right where it stopped is shown once
+        while (i+1 < map.size() && map[i+1].section == map[i].section && map[i+1].address == address + length)
+            length += map[++i].length;
+        
+        out << sections[map[i].section].name << ", " << address << ", " << address + length - 1 << ", " << length << endl;
+    }
+}
+
+bool assembler::export_memory_map(string file)
+{
+    ofstream outstream;
+    outstream.open(file.c_str());
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        errors_exist = true;
+        return false;
+    }
+    
+    display_memory_map(outstream);
+    outstream.close();
+    return true;
+}
+
+bool assembler::assemble_line(string instline, vector<int> &bytes)
+{
+    int line_number = 0;
+    int error_count = 0;
+    int first_byte = outbytes.size();
+    string mnemonic;
+    string argument1;
+    string argument2;
+    
+    bytes.clear();
+    
+    if (!tpl_open)
+        return false;
+    
+    if (tpl_inst_count < 0 && !template_file_check())
+        return false;
+    
+    read(instline, mnemonic, argument1, argument2);
+    substitute_constant(argument1); //constants are numbers from here on, in the key as well
+    substitute_constant(argument2);
+    
+    //a symbol operand is left out of the key and put back on a hit, so jumps to different labels share one entry;
+    //a name can spell a register and a label at once, so which operand is the symbol is part of the key
+    bool symbol1 = names_symbol(argument1);
+    bool symbol2 = names_symbol(argument2) && !symbol1;
+    string symbol = symbol1 ? argument1 : symbol2 ? argument2 : "";
+    string key = mnemonic + ' ' + (symbol1 ? symbol_slot(argument1) : argument1) + ',' + (symbol2 ? symbol_slot(argument2) : argument2);
+    
+    key += (char)('0' + (relocatable ? 4 : 0) + (symbol1 ? 2 : 0) + (symbol2 ? 1 : 0));
+    symbol = bs_util::is_pointer(symbol) ? bs_util::remove_outer_chars(symbol) : symbol;
+    stats::count(STAT_CACHE_LOOKUPS);
+    
+    {
+        lock_guard<mutex> hold(encoding_lock);
+        unordered_map<string, cached_encoding> &encodings = encoding_cache[filename_tpl];
+        unordered_map<string, cached_encoding>::const_iterator found = encodings.find(key);
+        
+        if (found != encodings.end())
+        {
+            bytes = found->second.bytes;
+            operand_fixup = found->second.fixup;
+            inst_cycles = found->second.cycles;
+            operand_symbol = (operand_fixup != FIXUP_NONE) ? symbol : "";
+            operand_name = -1;
+            stats::count(STAT_CACHE_HITS);
+            stats::count(STAT_BYTES_EMITTED, bytes.size());
+            return true;
+        }
+    }
+    
+    if (!resolve_instruction(error_count, line_number, mnemonic, argument1, argument2))
+        return false;
+    
+    bytes.assign(outbytes.begin() + first_byte, outbytes.end());
+    
+    if (operand_fixup != FIXUP_NONE && operand_symbol != symbol) //not the slot the key was made for
+        return true;
+    
+    {
+        lock_guard<mutex> hold(encoding_lock);
+        unordered_map<string, cached_encoding> &encodings = encoding_cache[filename_tpl];
+        cached_encoding encoded = { bytes, operand_fixup, inst_cycles };
+        
+        //sources made of lines that never repeat would otherwise keep every one of them
+        if (encodings.size() >= ENCODING_CACHE_LIMIT)
+            encodings.clear();
+        
+        encodings[key] = encoded;
+    }
+    
+    return true;
+}
+
+bool assembler::assemble_tokens(const token_ir &lines, int line, vector<int> &bytes)
+{
+    int kind1 = lines.kinds1[line];
+    int kind2 = lines.kinds2[line];
+    int value1 = lines.values1[line];
+    int value2 = lines.values2[line];
+    
+    //operands kept as text are keyed on how they are written, which only assemble_line does
+    if (kind1 == OPERAND_TEXT || kind2 == OPERAND_TEXT)
+        return assemble_line(lines.spell_line(line), bytes);
+    
+    //a constant is the number it stands for from here on, so its line has the shape of the number written out
+    if ((kind1 & ~OPERAND_POINTER) == OPERAND_NAME && name_class(lines, value1) == SYMBOL_CONSTANT)
+    {
+        kind1 += OPERAND_NUMBER - OPERAND_NAME;
+        value1 = name_values[value1];
+    }
+    
+    if ((kind2 & ~OPERAND_POINTER) == OPERAND_NAME && name_class(lines, value2) == SYMBOL_CONSTANT)
+    {
+        kind2 += OPERAND_NUMBER - OPERAND_NAME;
+        value2 = name_values[value2];
+    }
+    
+    //the same rules as the key of assemble_line, with ids in place of text
+    bool symbol1 = (kind1 & ~OPERAND_POINTER) == OPERAND_NAME && name_class(lines, value1) == SYMBOL_LABEL;
+    bool symbol2 = (kind2 & ~OPERAND_POINTER) == OPERAND_NAME && name_class(lines, value2) == SYMBOL_LABEL && !symbol1;
+    int symbol = symbol1 ? value1 : symbol2 ? value2 : -1;
+    line_shape shape = { lines.mnemonics[line], kind1 | (kind2 << 4) | (symbol1 ? 256 : 0) | (symbol2 ? 512 : 0),
+                         symbol1 ? -1 : value1, symbol2 ? -1 : value2 };
+    unordered_map<line_shape, cached_encoding, line_shape_hash>::const_iterator found = shapes.find(shape);
+    
+    if (found != shapes.end())
+    {
+        bytes = found->second.bytes;
+        operand_fixup = found->second.fixup;
+        inst_cycles = found->second.cycles;
+        operand_name = (operand_fixup != FIXUP_NONE) ? symbol : -1;
+        stats::count(STAT_CACHE_LOOKUPS);
+        stats::count(STAT_CACHE_HITS);
+        stats::count(STAT_BYTES_EMITTED, bytes.size());
+        return true;
+    }
+    
+    //the first line of a shape is spelled out and looked up by text, which other threads and runs share
+    if (!assemble_line(lines.spell_line(line), bytes))
+        return false;
+    
+    if (operand_fixup != FIXUP_NONE && (symbol < 0 || operand_symbol != lines.names[symbol]))
+        return true;
+    
+    operand_name = (operand_fixup != FIXUP_NONE) ? symbol : -1;
+    
+    if (shapes.size() >= ENCODING_CACHE_LIMIT)
+        shapes.clear();
+    
+    cached_encoding encoded = { bytes, operand_fixup, inst_cycles };
+    shapes[shape] = encoded;
+    return true;
+}
+
+bool assembler::names_symbol(const string &arg)
+{
+    return arg != "" && is_symbol(bs_util::is_pointer(arg) ? bs_util::remove_outer_chars(arg) : arg);
+}
+
+int assembler::name_class(const token_ir &lines, int id)
+{
+    if (id >= name_classes.size())
+    {
+        name_classes.resize(lines.names.size(), -1);
+        name_values.resize(lines.names.size(), 0);
+    }
+    
+    if (name_classes[id] < 0)
+    {
+        unordered_map<string, symbol_entry>::const_iterator found = symbols.find(lines.names[id]);
+        
+        //registers and conditions keep their meaning even where a constant has the same name
+        if (found != symbols.end() && found->second.label < 0 && table_of_arguments(lines.names[id]) < 0)
+        {
+            name_classes[id] = SYMBOL_CONSTANT;
+            name_values[id] = found->second.value;
+        }
+        else
+            name_classes[id] = is_symbol(lines.names[id]) ? SYMBOL_LABEL : SYMBOL_NONE;
+    }
+    
+    return name_classes[id];
+}
+
+void assembler::substitute_constant(string &arg)
+{
+    bool pointer = arg.length() > 1 && bs_util::is_pointer(arg);
+    string name = pointer ? bs_util::remove_outer_chars(arg) : arg;
+    unordered_map<string, symbol_entry>::const_iterator found = symbols.find(name);
+    
+    if (found == symbols.end() || found->second.label >= 0 || table_of_arguments(name) >= 0)
+        return;
+    
+    arg = pointer ? "(" : "";
+    bs_util::append_int(arg, found->second.value);
+    arg += pointer ? ")" : "";
+}
+
+string assembler::symbol_slot(const string &arg)
+{
+    return bs_util::is_pointer(arg) ? "(@)" : "@";
+}
+
+void assembler::read(string instruction, string &mnem, string &arg1, string &arg2)
+{
+    span m, a1, a2;
+    const char* text = instruction.data();
+    
+    //split the instruction into a mnemonic and 0-2 arguments
+    lexer::split_instruction(text, 0, instruction.length(), m, a1, a2);
+    mnem.assign(text + m.start, m.length);
+    arg1.assign(text + a1.start, a1.length);
+    arg2.assign(text + a2.start, a2.length);
+}
+
+bool assembler::template_file_check()
+{
+    char read_buffer;
+    const short FORMAT_CHECK_SIZE = 5;
+    char format_check[FORMAT_CHECK_SIZE+1];
+    int version_check;
+    
+    stream_tpl.seekg(0, stream_tpl.beg);
+    
+    //check if template file is correct
+    stream_tpl.read(format_check, sizeof(char)*FORMAT_CHECK_SIZE);
+    format_check[FORMAT_CHECK_SIZE] = '\0'; //null terminated string
+    
+    if (string(format_check) != "siasm")
+    {
+        cout << filename_tpl << " is not of the correct format!" << endl;
+        return false;
+    }
+    
+    //check if template file is of the correct version
+    stream_tpl.get(read_buffer);
+    version_check = (uchar)read_buffer;
+    
+    if (version_check != version)
+    {
+        cout << filename_tpl << " is outdated. Cannot continue!" << endl;
+        return false;
+    }
+    
+    //get instruction count from template file
+    stream_tpl.get(read_buffer);
+    tpl_inst_count = (uchar)read_buffer;
+    
+    return true; //true indicates the file passes the check
+}
+
+bool assembler::scan_template_file(string mnem, string arg1, string arg2)
+{
+    bool      complete = false;
+    char      read_buffer;
+    char      inst_byte1;
+    int       name_length;
+    char*     inst_name;
+    
+    int       arg_combo_num;
+    const int ARG_BYTES = 6;
+    char      arg_combo[ARG_BYTES];
+    int       inst_crnt = 0;                        //current instruction
+    stat_timer timer(PHASE_LOOKUP);
+    
+    stats::count(STAT_TEMPLATE_SCANS);
+    tpl_scans++;
+    stream_tpl.seekg(7,stream_tpl.beg);             //move to beginnning of search section after file version
+    
+    while (inst_crnt < tpl_inst_count && !complete)
+    {
+        stream_tpl.read(&inst_byte1, sizeof(char)); //read first byte to tell us length of instruction string
+        
+        //instruction name
+        name_length = (inst_byte1 & 3) + 2;         //length is the rightmost two bits, 00 = 2, 10 = 4
+        inst_name = new char[name_length+1];        //plus one for null terminator
+        stream_tpl.read(inst_name, name_length);    //get the name characters
+        inst_name[name_length] = '\0';              //end the string
+        
+        //argument combinations
+        stream_tpl.read(&read_buffer, sizeof(char));
+        arg_combo_num = (uchar)read_buffer;
+        
+        if (string(inst_name) == mnem)
+        {
+            for (int i = 0; i < arg_combo_num; i++)
+            {
+                stream_tpl.read(arg_combo, sizeof(char)*ARG_BYTES);
+                
+                if ((int)(uchar)arg_combo[0] == table_of_arguments(arg1))
+                {
+                    if ((int)(uchar)arg_combo[1] == table_of_arguments(arg2))
+                    {
+                        inst_value = (int)(uchar)arg_combo[2];
+                        inst_prefix = (int)(uchar)arg_combo[3];
+                        inst_index = (int)(uchar)arg_combo[4];
+                        inst_cycles = (int)(uchar)arg_combo[5];
+                        complete = true;
+                        break;
+                    }
+                }
+            }
+        }
+        else //skip to next instruction
+            stream_tpl.seekg(ARG_BYTES*((int)(uchar)read_buffer), stream_tpl.cur);
+        
+        inst_crnt++;
+        delete inst_name;
+    }
+    
+    return complete;
+}
+
+int assembler::table_of_arguments(string arg)
+{
+    int output = -1;
+    
+    for (int i = 0; i < ARG_TABLE_LENGTH; i++)
+    {
+        if (arg == argument_table[i])
+        {
+            output = i;
+            break;
+        }
+    }
+    
+    return output;
+}
+
+const char* assembler::argument_spelling(int arg)
+{
+    if (arg < 0 || arg >= ARG_TABLE_LENGTH)
+        return "";
+    
+    return argument_table[arg];
+}
+
+void assembler::adjust_values(int pass, string *arg)
+{
+    switch (pass)
+    {
+        case ARG_2B_CONST:
+        {
+            bool is_pointer = false;
+            bool is_label = false;
+            string arg_copy = *arg;
+            
+            if (bs_util::is_pointer(*arg))
+            {
+                arg_copy = bs_util::remove_outer_chars(*arg);
+                is_pointer = true;
+            }
+            
+            if (bs_util::is_all_numeric(arg_copy))
+            {
+                if (bs_util::can_be_two_byte_value(atoi((arg_copy).c_str())))
+                {
+                    if (is_pointer)
+                        *arg = "(NN)";
+                    else
+                        *arg = "NN";
+                }
+                else throw argument_out_of_range();
+            }
+            else
+            {
+                is_label = is_symbol(arg_copy);
+                
+                if (is_label)
+                {
+                    if (!quiet)
+                        cout << "Found a label here." << endl;
+                    
+                    if (is_pointer)
+                        *arg = "(NN)";
+                    else
+                        *arg = "NN";	
+                }
+                else throw instruction_not_found();
+            }
+
+            break;
+        }
+
+        case ARG_1B_CONST:
+        {
+            if (bs_util::can_be_one_byte_value(atoi((*arg).c_str())))
+            {
+                if (bs_util::is_pointer(*arg)) //eight-bit values are never pointers
+                    throw instruction_not_found();
+                else
+                    *arg = "N";
+            }
+            else throw argument_out_of_range();
+
+            break;
+        }
+
+        case ARG_1B_DISP:
+        {
+            if (bs_util::can_be_signed_one_byte_value(atoi((*arg).c_str())))
+                *arg = "DIS";
+            else
+                throw argument_out_of_range();
+            
+            break;
+        }
+    }
+}
+
+bool assembler::process_directive(int &error_amount, int &line_num, string mnem, string arg1, string arg2)
+{
+    if (mnem == "org")
+    {
+        substitute_constant(arg1);
+        
+        if (arg2 != "" || !bs_util::is_all_numeric(arg1) || atoi(arg1.c_str()) < 0 || atoi(arg1.c_str()) > 65535)
+        {
+            display_error(line_num, "org needs an address from 0 to 65535", mnem, arg1, arg2);
+            error_amount++;
+            return true;
+        }
+        
+        sections[crnt_section].address = atoi(arg1.c_str());
+        sections[crnt_section].fixed = true;
+        start_region();
+        return true;
+    }
+    
+    if (mnem == "section")
+    {
+        int found = -1;
+        
+        substitute_constant(arg2);
+        
+        if (!bs_util::is_all_alphabetic(arg1) || (arg2 != "" && (!bs_util::is_all_numeric(arg2) || atoi(arg2.c_str()) < 0 || atoi(arg2.c_str()) > 65535)))
+        {
+            display_error(line_num, "section needs an alphabetic name and an optional address from 0 to 65535", mnem, arg1, arg2);
+            error_amount++;
+            return true;
+        }
+        
+        for (int i = 0; i < sections.size(); i++)
+        {
+            if (sections[i].name == arg1)
+                found = i;
+        }
+        
+        //a section picks up where it left off unless it is given a new address
+        if (found < 0)
+        {
+            section new_section = { arg1, 0, false };
+            sections.push_back(new_section);
+            found = sections.size() - 1;
+        }
+        
+        crnt_section = found;
+        
+        if (arg2 != "")
+        {
+            sections[crnt_section].address = atoi(arg2.c_str());
+            sections[crnt_section].fixed = true;
+        }
+        
+        start_region();
+        return true;
+    }
+    
+    if (mnem == "page" || mnem == "nopagecross")
+    {
+        page_check c = { (mnem == "page") ? PAGE_START : PAGE_NO_CROSS, line_num, crnt_section, sections[crnt_section].address, -1 };
+        
+        if (arg1 != "")
+            display_error(line_num, mnem + " takes no arguments", mnem, arg1, arg2);
+        else if (relocatable && !sections[crnt_section].fixed)
+            display_error(line_num, mnem + " needs a section with an address when assembling an object", mnem, arg1, arg2);
+        else
+        {
+            //a block has one check, a second directive in it closes the first where it stands
+            if (page_checks.size() > 0 && page_checks.back().end < 0)
+                page_checks.back().end = sections[page_checks.back().section].address;
+            
+            page_checks.push_back(c);
+            return true;
+        }
+        
+        error_amount++;
+        return true;
+    }
+    
+    if (mnem == "assert_cycles" || mnem == "assert_size")
+    {
+        unordered_map<string, symbol_entry>::const_iterator found = symbols.find(arg1);
+        
+        substitute_constant(arg2);
+        
+        //when streaming the label can still come further on, check_budgets looks for it once every line is read
+        bool later = streaming && found == symbols.end() && bs_util::is_name(arg1);
+        
+        if ((!later && (found == symbols.end() || found->second.label < 0)) || !bs_util::is_all_numeric(arg2) || atoi(arg2.c_str()) < 0)
+        {
+            display_error(line_num, mnem + " needs a label of this program and a budget of 0 or more", mnem, arg1, arg2);
+            error_amount++;
+            return true;
+        }
+        
+        budget_check c = { (mnem == "assert_cycles") ? BUDGET_CYCLES : BUDGET_SIZE, line_location(line_num),
+                           later ? -1 : found->second.label, atoi(arg2.c_str()), arg1 };
+        budget_checks.push_back(c);
+        return true;
+    }
+    
+    return false;
+}
+
+static bool label_line_before(int line, const label* l)
+{
+    return line < l->line;
+}
+
+static bool label_line_after(const label* l, int line)
+{
+    return l->line < line;
+}
+
+void assembler::check_pages(int &error_amount)
+{
+    for (int i = 0; i < page_checks.size(); i++)
+    {
+        const page_check &c = page_checks[i];
+        int end = (c.end < 0) ? sections[c.section].address : c.end;
+        int found = upper_bound(labels.begin(), labels.end(), c.line, label_line_before) - labels.begin() - 1;
+        int start = c.start;
+        string name = "before any label";
+        
+        //the block starts at its label, unless the label is in another section
+        if (found >= 0)
+        {
+            name = labels[found]->name;
+            
+            if (label_sections[found] == c.section)
+                start = labels[found]->value;
+        }
+        
+        if (c.kind == PAGE_START && start % PAGE_SIZE != 0)
+        {
+            cout << "Page error, block " << name << " at " << start << " to " << end - 1 << " does not start on a page" << endl;
+            error_amount++;
+        }
+        else if (end > start && start / PAGE_SIZE != (end - 1) / PAGE_SIZE)
+        {
+            cout << "Page error, block " << name << " at " << start << " to " << end - 1 << " crosses a page boundary at ";
+            cout << (start / PAGE_SIZE + 1) * PAGE_SIZE << endl;
+            error_amount++;
+        }
+    }
+}
+
+void assembler::check_budgets(int &error_amount)
+{
+    for (int i = 0; i < budget_checks.size(); i++)
+    {
+        budget_check &c = budget_checks[i];
+        
+        if (c.label < 0)
+        {
+            unordered_map<string, symbol_entry>::const_iterator found = symbols.find(c.name);
+            
+            if (found == symbols.end() || found->second.label < 0)
+            {
+                cout << "Budget error, the assert at " << c.where << " names " << c.name << ", which is not a label of this program" << endl;
+                error_amount++;
+                continue;
+            }
+            
+            c.label = found->second.label;
+        }
+        
+        int next = c.label + 1;
+        
+        //labels on the same line share a block, which the first label after them ends
+        while (next < labels.size() && labels[next]->line == labels[c.label]->line)
+            next++;
+        
+        long long cycles = ((next < labels.size()) ? label_cycles[next] : cycle_count) - label_cycles[c.label];
+        int bytes = ((next < labels.size()) ? label_bytes[next] : byte_count) - label_bytes[c.label];
+        
+        if (c.kind == BUDGET_CYCLES && cycles > c.limit)
+        {
+            cout << "Budget error, block " << labels[c.label]->name << " takes " << cycles << " T-states, ";
+            cout << cycles - c.limit << " over the " << c.limit << " allowed by assert_cycles at " << c.where << endl;
+            error_amount++;
+        }
+        else if (c.kind == BUDGET_SIZE && bytes > c.limit)
+        {
+            cout << "Budget error, block " << labels[c.label]->name << " is " << bytes << " bytes, ";
+            cout << bytes - c.limit << " over the " << c.limit << " allowed by assert_size at " << c.where << endl;
+            error_amount++;
+        }
+    }
+}
+
+bool assembler::process_data(int &error_amount, int &line_num, string mnem, string arg1, string arg2)
+{
+    vector<string> items; //arguments split at every comma, read only split off the first one
+    string list = (arg2 != "") ? arg1 + ',' + arg2 : arg1;
+    string err_msg;
+    int first_byte = outbytes.size();
+    vector<fixup_site> pending; //dw values that name labels
+    
+    for (int start = 0, comma; start <= list.length(); start = comma + 1)
+    {
+        comma = list.find(',', start);
+        
+        if (comma == string::npos)
+            comma = list.length();
+        
+        items.push_back(bs_util::trim(list.substr(start, comma - start)));
+        substitute_constant(items.back());
+    }
+    
+    if (mnem == "incbin")
+    {
+        int offset = 0;
+        int length = -1; //rest of the file
+        
+        if (items.size() > 3 || items[0].length() < 3 || items[0][0] != '"' || items[0][items[0].length()-1] != '"')
+            err_msg = "incbin needs a quoted file name and an optional offset and length";
+        
+        for (int i = 1; i < items.size() && err_msg == ""; i++)
+        {
+            if (!bs_util::is_all_numeric(items[i]) || atoi(items[i].c_str()) < 0)
+                err_msg = "incbin offset and length must be positive numbers";
         }
         
-        if (error_count == 0)
+        if (err_msg == "")
         {
-            for (int i = 0; i < outbytes.size(); i++)
-                cout << outbytes[i] << endl;
+            if (items.size() > 1)
+                offset = atoi(items[1].c_str());
             
-            cout << "SUCCESS" << endl;
-            cout << endl << "Displaying label table: " << endl;
+            if (items.size() > 2)
+                length = atoi(items[2].c_str());
             
-            for (int i = 0; i < labels.size(); i++)
-                cout << labels[i]->name << ", " << labels[i]->line << ", " << labels[i]->value << endl;
+            include_binary(bs_util::remove_outer_chars(items[0]), offset, length, err_msg);
         }
-        else cout << "Could not go further due to " << error_count << " error(s).";
     }
-    else cout << "File(s) could not be opened to read!" << endl;
-    
-    stream_tpl.close();
-    stream_inst.close();
-}
-
-void assembler::read(string instruction, string &mnem, string &arg1, string &arg2)
-{
-    char ic; //instruction character
-
-    //run through the characters of an instruction
-    for (int i = 0, j = instruction.length(), k = 0; i < j; i++)
+    else if (mnem == "ds")
     {
-        ic = instruction[i];
-
-        //split the instruction into a mnemonic and 0-2 arguments
-        switch (k)
+        //ds count[,fill] reserves count bytes, all set to fill or zero
+        if (items.size() > 2 || !bs_util::is_all_numeric(items[0]) || atoi(items[0].c_str()) < 0 || atoi(items[0].c_str()) > 65536)
+            err_msg = "ds needs a count from 0 to 65536 and an optional fill byte";
+        else if (items.size() > 1 && (!bs_util::is_all_numeric(items[1]) || !bs_util::can_be_one_byte_value(atoi(items[1].c_str()))))
+            err_msg = "argument out of range";
+        else
+            outbytes.insert(outbytes.end(), atoi(items[0].c_str()), (items.size() > 1) ? bs_util::num_get_lsb(atoi(items[1].c_str())) : 0);
+    }
+    else if (mnem == "dbtable" || mnem == "dwtable")
+        generate_table(items, mnem == "dwtable", err_msg);
+    else if (mnem == "align")
+    {
+        //align boundary[,fill] pads the section up to the next multiple of boundary
+        int boundary = atoi(items[0].c_str());
+        
+        if (items.size() > 2 || !bs_util::is_all_numeric(items[0]) || boundary < 1 || boundary > 65536)
+            err_msg = "align needs a boundary from 1 to 65536 and an optional fill byte";
+        else if (items.size() > 1 && (!bs_util::is_all_numeric(items[1]) || !bs_util::can_be_one_byte_value(atoi(items[1].c_str()))))
+            err_msg = "argument out of range";
+        else if (relocatable && !sections[crnt_section].fixed)
+            err_msg = "align needs a section with an address when assembling an object";
+        else
         {
-            case 0: if (ic != ' ') mnem += ic; else k = 1; break;
-            case 1: if (ic != ',') arg1 += ic; else k = 2; break;
-            default: arg2 += ic; break;
+            int padding = (boundary - sections[crnt_section].address % boundary) % boundary;
+            outbytes.insert(outbytes.end(), padding, (items.size() > 1) ? bs_util::num_get_lsb(atoi(items[1].c_str())) : 0);
         }
     }
-    
-    mnem = bs_util::trim(mnem);
-    arg1 = bs_util::trim(arg1);
-    arg2 = bs_util::trim(arg2);
-}
-
-bool assembler::template_file_check()
-{
-    char read_buffer;
-    const short FORMAT_CHECK_SIZE = 5;
-    char format_check[FORMAT_CHECK_SIZE+1];
-    int version_check;
-    
-    //check if template file is correct
-    stream_tpl.read(format_check, sizeof(char)*FORMAT_CHECK_SIZE);
-    format_check[FORMAT_CHECK_SIZE] = '\0'; //null terminated string
-    
-    if (string(format_check) != "siasm")
+    else //db and dw take a list of values
     {
-        cout << filename_tpl << " is not of the correct format!" << endl;
-        return false;
+        for (int i = 0; i < items.size() && err_msg == ""; i++)
+        {
+            int value = atoi(items[i].c_str());
+            
+            if (mnem == "dw" && is_symbol(items[i]))
+            {
+                outbytes.push_back(0);
+                outbytes.push_back(0);
+                fixup_site f = { FIXUP_WORD, spilled + (int)outbytes.size() - 2, 0, -1, items[i] };
+                pending.push_back(f); //noted once the bytes are placed
+            }
+            else if (!bs_util::is_all_numeric(items[i]))
+                err_msg = mnem + " values must be numbers, or labels for dw";
+            else if (mnem == "db" && bs_util::can_be_one_byte_value(value))
+                outbytes.push_back(bs_util::num_get_lsb(value));
+            else if (mnem == "dw" && bs_util::can_be_two_byte_value(value))
+            {
+                outbytes.push_back(bs_util::num_get_lsb(value));
+                outbytes.push_back(bs_util::num_get_msb(value));
+            }
+            else
+                err_msg = "argument out of range";
+        }
     }
     
-    //check if template file is of the correct version
-    stream_tpl.get(read_buffer);
-    version_check = (uchar)read_buffer;
-    
-    if (version_check != version)
+    if (err_msg != "")
     {
-        cout << filename_tpl << " is outdated. Cannot continue!" << endl;
+        outbytes.resize(first_byte);
+        display_error(line_num, err_msg, mnem, arg1, arg2);
+        error_amount++;
         return false;
     }
     
-    //get instruction count from template file
-    stream_tpl.get(read_buffer);
-    tpl_inst_count = (uchar)read_buffer;
-    
-    return true; //true indicates the file passes the check
+    stats::count(STAT_BYTES_EMITTED, outbytes.size() - first_byte);
+    place_bytes(first_byte);
+    fixups.insert(fixups.end(), pending.begin(), pending.end());
+    return true;
 }
 
-bool assembler::scan_template_file(string mnem, string arg1, string arg2)
+void assembler::generate_table(const vector<string> &items, bool words, string &err_msg)
 {
-    bool      complete = false;
-    char      read_buffer;
-    char      inst_byte1;
-    int       name_length;
-    char*     inst_name;
+    expression formula;
+    expr_symbols index = (constants != NULL) ? *constants : expr_symbols(); //expressions can use constants too
+    expr_value result;
+    int first = atoi(items[0].c_str());
+    int last = (items.size() > 1) ? atoi(items[1].c_str()) : 0;
+    int fraction_bits = (items.size() > 3) ? atoi(items[3].c_str()) : 0;
     
-    int       arg_combo_num;
-    const int ARG_BYTES = 4;
-    char      arg_combo[ARG_BYTES];
-    int       inst_crnt = 0;                        //current instruction
+    if (items.size() < 3 || items.size() > 4 || !bs_util::is_all_numeric(items[0]) || !bs_util::is_all_numeric(items[1])
+        || last < first || last - first >= 65536)
+    {
+        err_msg = "tables need a first and last index, no more than 65536 apart, and an expression";
+        return;
+    }
     
-    stream_tpl.seekg(7,stream_tpl.beg);             //move to beginnning of search section after file version
+    if (items.size() > 3 && (!bs_util::is_all_numeric(items[3]) || fraction_bits < 0 || fraction_bits > 15))
+    {
+        err_msg = "fraction bits must be from 0 to 15";
+        return;
+    }
     
-    while (inst_crnt < tpl_inst_count && !complete)
+    if (!formula.parse(items[2], err_msg))
+        return;
+    
+    //the expression is parsed once and worked out for every index, which it sees as i
+    for (int i = first; i <= last; i++)
     {
-        stream_tpl.read(&inst_byte1, sizeof(char)); //read first byte to tell us length of instruction string
+        long long value;
+        index["i"] = i;
         
-        //instruction name
-        name_length = (inst_byte1 & 3) + 2;         //length is the rightmost two bits, 00 = 2, 10 = 4
-        inst_name = new char[name_length+1];        //plus one for null terminator
-        stream_tpl.read(inst_name, name_length);    //get the name characters
-        inst_name[name_length] = '\0';              //end the string
+        if (!formula.evaluate(index, result, err_msg))
+        {
+            ostringstream where;
+            where << err_msg << " at i = " << i;
+            err_msg = where.str();
+            return;
+        }
         
-        //argument combinations
-        stream_tpl.read(&read_buffer, sizeof(char));
-        arg_combo_num = (uchar)read_buffer;
+        value = expression::scaled(result, fraction_bits);
         
-        if (string(inst_name) == mnem)
+        if (value < -32768 || value > 65535
+            || !(words ? bs_util::can_be_two_byte_value(value) : bs_util::can_be_one_byte_value(value)))
         {
-            for (int i = 0; i < arg_combo_num; i++)
-            {
-                stream_tpl.read(arg_combo, sizeof(char)*ARG_BYTES);
-                
-                if ((int)(uchar)arg_combo[0] == table_of_arguments(arg1))
-                {
-                    if ((int)(uchar)arg_combo[1] == table_of_arguments(arg2))
-                    {
-                        inst_value = (int)(uchar)arg_combo[2];
-                        inst_prefix = (int)(uchar)arg_combo[3];
-                        complete = true;
-                        break;
-                    }
-                }
-            }
+            ostringstream where;
+            where << "argument out of range, " << value << " at i = " << i;
+            err_msg = where.str();
+            return;
         }
-        else //skip to next instruction
-            stream_tpl.seekg(4*((int)(uchar)read_buffer), stream_tpl.cur);
         
-        inst_crnt++;
-        delete inst_name;
+        outbytes.push_back(bs_util::num_get_lsb(value));
+        
+        if (words)
+            outbytes.push_back(bs_util::num_get_msb(value));
     }
-    
-    return complete;
 }
 
-int assembler::table_of_arguments(string arg)
+bool assembler::include_binary(string file, int offset, int length, string &err_msg)
 {
-    int output = -1;
-    const int table_length = 48; //this value will need to change if you update the table
+    mapped_file* binary = NULL;
     
-    static const char* table[table_length] = {
-        "",     "N",  "NN",  "(NN)", "DIS", "$",
-        "b",    "c",  "bc",  "(bc)",
-        "d",    "e",  "de",  "(de)",
-        "h",    "l",  "hl",  "(hl)",
-        "a",    "af", "af'", "sp",
-        "(sp)", "i",  "r",   "(c)",
-        "nz",   "z",  "nc",  "po",
-        "pe",   "p",  "m",
-        "0",    "1",  "2",   "3",    "4",   "5",  "6", "7",
-        "8",    "16", "24",  "32",   "40",  "48", "56"
-    };
+    //the same file brought in more than once is only mapped once
+    for (int i = 0; i < binaries.size() && binary == NULL; i++)
+    {
+        if (binaries[i]->name() == file)
+            binary = binaries[i];
+    }
     
-    for (int i = 0; i < table_length; i++)
+    if (binary == NULL)
     {
-        if (arg == table[i])
+        binary = new mapped_file();
+        
+        if (!binary->open(file))
         {
-            output = i;
-            break;
+            err_msg = file + " could not be opened to read";
+            delete binary;
+            return false;
         }
+        
+        binaries.push_back(binary);
     }
     
-    return output;
+    if (length < 0)
+        length = binary->size() - offset;
+    
+    if (offset > binary->size() || length < 0 || length > binary->size() - offset)
+    {
+        err_msg = "incbin reaches past the end of " + file;
+        return false;
+    }
+    
+    if (length == 0)
+        return true;
+    
+    //the file gets a region of its own, whatever is assembled next starts another
+    region r = { crnt_section, sections[crnt_section].address, spilled + (int)outbytes.size(), length, binary->data() + offset };
+    
+    if (regions.back().length == 0)
+        regions.back() = r;
+    else
+        regions.push_back(r);
+    
+    sections[crnt_section].address += length;
+    byte_count += length;
+    stats::count(STAT_BYTES_EMITTED, length);
+    start_region();
+    return true;
 }
 
-void assembler::adjust_values(int pass, string *arg)
+void assembler::start_region()
 {
-    switch (pass)
+    region r = { crnt_section, sections[crnt_section].address, spilled + (int)outbytes.size(), 0, NULL };
+    
+    if (regions.size() > 0 && regions.back().length == 0) //nothing was assembled since the last one
+        regions.back() = r;
+    else
+        regions.push_back(r);
+}
+
+void assembler::place_bytes(int first_byte)
+{
+    int length = outbytes.size() - first_byte;
+    
+    regions.back().length += length;
+    sections[crnt_section].address += length;
+    byte_count += length;
+}
+
+static bool region_before(const region &a, const region &b)
+{
+    return a.address < b.address;
+}
+
+vector<region> assembler::memory_map(bool report)
+{
+    vector<region> map;
+    int last_end = 0; //highest address reached by the regions checked so far
+    int last = -1;    //region that reached it
+    
+    for (int i = 0; i < regions.size(); i++)
     {
-        case ARG_2B_CONST:
+        if (regions[i].length > 0)
+            map.push_back(regions[i]);
+    }
+    
+    stable_sort(map.begin(), map.end(), region_before);
+    
+    for (int i = 0; i < map.size() && report; i++)
+    {
+        int end = map[i].address + map[i].length;
+        
+        if (end > 65536)
         {
-            bool is_pointer = false;
-            bool is_label = false;
-            string arg_copy = *arg;
-            
-            if (bs_util::is_pointer(*arg))
-            {
-                arg_copy = bs_util::remove_outer_chars(*arg);
-                is_pointer = true;
-            }
-            
-            if (bs_util::is_all_numeric(arg_copy))
-            {
-                if (bs_util::can_be_two_byte_value(atoi((arg_copy).c_str())))
-                {
-                    if (is_pointer)
-                        *arg = "(NN)";
-                    else
-                        *arg = "NN";
-                }
-                else throw argument_out_of_range();
-            }
-            else
-            {
-                for (int i = 0; i < labels.size(); i++)
-                    is_label = (is_label || arg_copy == labels[i]->name);
-                
-                if (is_label)
-                {
-                    cout << "Found a label here." << endl;
-                    
-                    if (is_pointer)
-                        *arg = "(NN)";
-                    else
-                        *arg = "NN";	
-                }
-                else throw instruction_not_found();
-            }
-
-            break;
+            cout << "Memory error, section " << sections[map[i].section].name << " at " << map[i].address;
+            cout << " runs " << end - 65536 << " byte(s) past the end of memory" << endl;
+            errors_exist = true;
         }
-
-        case ARG_1B_CONST:
+        
+        if (last >= 0 && map[i].address < last_end)
         {
-            if (bs_util::can_be_one_byte_value(atoi((*arg).c_str())))
-            {
-                if (bs_util::is_pointer(*arg)) //eight-bit values are never pointers
-                    throw instruction_not_found();
-                else
-                    *arg = "N";
-            }
-            else throw argument_out_of_range();
-
-            break;
+            cout << "Memory error, section " << sections[map[i].section].name << " at " << map[i].address << "-" << end - 1;
+            cout << " overlaps section " << sections[map[last].section].name << " at " << map[last].address << "-" << last_end - 1 << endl;
+            errors_exist = true;
         }
-
-        case ARG_1B_DISP:
+        
+        if (end > last_end)
         {
-            if (bs_util::can_be_signed_one_byte_value(atoi((*arg).c_str())))
-                *arg = "DIS";
-            else
-                throw argument_out_of_range();
-            
-            break;
+            last_end = end;
+            last = i;
         }
     }
+    
+    return map;
+}
+
+bool assembler::adjust_index(string* arg, int &disp)
+{
+    string inner;
+    string offset;
+    
+    if (!bs_util::is_pointer(*arg))
+        return false;
+    
+    inner = bs_util::trim(bs_util::remove_outer_chars(*arg));
+    
+    if (inner.length() < 2 || (inner.substr(0, 2) != "ix" && inner.substr(0, 2) != "iy"))
+        return false;
+    
+    offset = bs_util::trim(inner.substr(2));
+    disp = 0; //(ix) on its own is the same as (ix+0)
+    
+    if (offset != "")
+    {
+        string number = bs_util::trim(offset.substr(1));
+        
+        substitute_constant(number);
+        
+        if ((offset[0] != '+' && offset[0] != '-') || !bs_util::is_all_numeric(number))
+            throw instruction_not_found();
+        
+        disp = atoi(number.c_str());
+        
+        if (offset[0] == '-')
+            disp = -disp;
+        
+        if (!bs_util::can_be_signed_one_byte_value(disp))
+            throw argument_out_of_range();
+    }
+    
+    *arg = "(" + inner.substr(0, 2) + "+DIS)";
+    return true;
 }
 
 bool assembler::resolve_instruction(int &error_amount, int &line_num, string mnem, string arg1, string arg2)
 {
     string* test_arg;
     int arg_byte_output = 0; //28x0 0ABB where A is which argument-1, and B is # of bytes
+    int displacement = 0;    //displacement of an indexed argument
+    bool indexed = false;    //true when an argument is (ix+d) or (iy+d)
 
     string temp_arg1 = arg1; //preserves original arguments
     string temp_arg2 = arg2;
+    
+    int first_byte = outbytes.size();
+    long long first_scan = tpl_scans;
+    stats::count(STAT_RESOLVE_CALLS);
+    operand_fixup = FIXUP_NONE;
+    operand_symbol = "";
+    operand_name = -1;
 
     try
     {
-        if (temp_arg1 == "" && temp_arg2 == "") //zero arguments
+        if (!scan_template_file(mnem, arg1, arg2))
         {
-            if (!scan_template_file(mnem, arg1, arg2))
+            //jp (ix) is matched above, any other indexed argument is looked up by its class
+            indexed = adjust_index(&arg1, displacement) || adjust_index(&arg2, displacement);
+            temp_arg1 = arg1;
+            temp_arg2 = arg2;
+            
+            if (indexed && scan_template_file(mnem, arg1, arg2))
+                arg_byte_output = 0; //the displacement was the only value in the instruction
+            else if (temp_arg1 == "" && temp_arg2 == "") //zero arguments
                 throw instruction_not_found();
-        }
-        else if (temp_arg1 != "" && temp_arg2 == "") //one argument
-        {
-            if (!scan_template_file(mnem, arg1, arg2))
+            else if (temp_arg1 != "" && temp_arg2 == "") //one argument
             {
                 adjust_values(ARG_2B_CONST, &arg1); //substitute value with NN and try again
                 
@@ -367,22 +2057,19 @@ bool assembler::resolve_instruction(int &error_amount, int &line_num, string mne
                 }
                 else arg_byte_output = 2;
             }
-        }
-        else //two arguments
-        {
-            if (!scan_template_file(mnem, arg1, arg2))
-            {	
+            else //two arguments
+            {
                 if (bs_util::is_pointer(arg1))
                     arg1 = bs_util::remove_outer_chars(arg1);
                 
-                if (bs_util::is_all_numeric(arg1)) //testing to see if arg1 is a const pointer
+                if (bs_util::is_all_numeric(arg1) || is_symbol(arg1)) //testing to see if arg1 is a const pointer
                     test_arg = &arg1;
                 else
                 {
                     if (bs_util::is_pointer(arg2)) //arg1 isn't a const pointer, let's see if arg2 is
                         arg2 = bs_util::remove_outer_chars(arg2);
                     
-                    if (bs_util::is_all_numeric(arg2))
+                    if (bs_util::is_all_numeric(arg2) || is_symbol(arg2))
                         arg_byte_output = 4; //set to arg2 output mode
                     
                     test_arg = &arg2;
@@ -415,21 +2102,27 @@ bool assembler::resolve_instruction(int &error_amount, int &line_num, string mne
     }
     catch (exception &e)
     {
+        stats::count(STAT_EXCEPTIONS);
+        stats::count(STAT_RESOLVE_RETRIES, tpl_scans - first_scan - 1);
         display_error(line_num, e.what(), mnem, arg1, arg2);
         error_amount++;
         return false;
     }
     
-    byte_count += (arg_byte_output & 3) + 1; //number of bytes for argument plus opcode byte
+    if (inst_index != 0)
+        outbytes.push_back(inst_index); //push the index register prefix
     
     if (inst_prefix != 0)
-    {
         outbytes.push_back(inst_prefix); //push any potential opcode prefixes
-        byte_count++;
-    }
+    
+    if (indexed && inst_prefix == 0xCB) //indexed bit instructions put the displacement before the opcode
+        outbytes.push_back(displacement);
     
     outbytes.push_back(inst_value); //push on the opcode
     
+    if (indexed && inst_prefix != 0xCB)
+        outbytes.push_back(displacement);
+    
     if ((arg_byte_output & 3) != 0) //non-zero values indicate we need to push on the argument
     {
         if ((arg_byte_output & 4) == 4) //decide which argument gets pushed
@@ -450,8 +2143,19 @@ bool assembler::resolve_instruction(int &error_amount, int &line_num, string mne
                 outbytes.push_back(bs_util::num_get_msb(atoi(test_arg->c_str())));
             break;
         }
+        
+        //a name in place of a number is filled in once its address is known
+        if (!bs_util::is_all_numeric(*test_arg))
+        {
+            operand_symbol = *test_arg;
+            operand_fixup = ((arg_byte_output & 3) == 2) ? FIXUP_WORD : (mnem == "jr" || mnem == "djnz") ? FIXUP_DISP : FIXUP_BYTE;
+        }
     }
     
+    place_bytes(first_byte); //prefixes, opcode, displacement, and argument bytes
+    
+    stats::count(STAT_RESOLVE_RETRIES, tpl_scans - first_scan - 1);
+    stats::count(STAT_BYTES_EMITTED, outbytes.size() - first_byte);
     return true;
 }
 
@@ -459,23 +2163,26 @@ void assembler::resolve_label_addresses(int &line_num, int &next_line)
 {
     if (next_line > 0 && next_line == line_num)
     {
-        int item = 0;
+        //labels are in line order, so the first one on this line is found without walking past every earlier one
+        int item = lower_bound(labels.begin(), labels.end(), line_num, label_line_after) - labels.begin();
         
-        while (labels[item]->line < line_num)
+        if (item == labels.size())
         {
-            if (item < labels.size()-1) //minus one prevents overflow
-                item++;
-            else
-            {
-                next_line = 0;
-                return;
-            }
+            next_line = 0;
+            return;
         }
         
+        //the first label after a page check ends its block
+        if (page_checks.size() > 0 && page_checks.back().end < 0 && line_num > page_checks.back().line)
+            page_checks.back().end = sections[page_checks.back().section].address;
+        
         while (labels[item]->line == line_num)
         {
-            labels[item]->value = byte_count + 1;
-            //plus one puts our location at the byte after the label instead of before
+            labels[item]->value = sections[crnt_section].address;
+            label_sections[item] = crnt_section;
+            label_bytes[item] = byte_count;
+            label_cycles[item] = cycle_count;
+            //the address the next byte of the current section will be assembled to
             
             if (item < labels.size()-1) //minus one prevents overflow
                 item++;
@@ -490,10 +2197,31 @@ void assembler::resolve_label_addresses(int &line_num, int &next_line)
     }
 }
 
+string assembler::line_location(int line_num)
+{
+    int at = line_num - 1 - token_base;
+    string location = "line ";
+    
+    bs_util::append_int(location, line_num);
+    
+    //lines from the preprocessor also know the file and line they were written on
+    if (at >= 0 && at < tokens->size() && tokens->files[at] >= 0)
+    {
+        location += " (" + tokens->file_names[tokens->files[at]] + " line ";
+        bs_util::append_int(location, tokens->source_lines[at]);
+        location += ")";
+    }
+    
+    return location;
+}
+
 void assembler::display_error(int line_num, string err_msg, string mnem, string arg1, string arg2)
 {	
-    cout << "Assembly error, in " << filename_inst;
-    cout << " at line " << line_num << " -> " << err_msg << ' ' << mnem;
+    if (quiet)
+        return;
+    
+    cout << "Assembly error, in " << filename_inst << " at " << line_location(line_num);
+    cout << " -> " << err_msg << ' ' << mnem;
     
     if (arg1 != "")
     {
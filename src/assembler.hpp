@@ -33,29 +33,199 @@
 #define ARG_1B_CONST 1
 #define ARG_1B_DISP  2
 
+#define ARG_TABLE_LENGTH 54 //number of argument classes known to the template file
+#define ARG_N            1  //template argument classes that carry a value in the output
+#define ARG_NN           2
+#define ARG_PNN          3
+#define ARG_DIS          4
+#define ARG_IX_DIS       52 //indexed classes carry a displacement byte
+#define ARG_IY_DIS       53
+
+#define CHUNK_LINES      4096 //lines handed to a thread at a time when encoding in parallel
+#define ENCODING_CACHE_LIMIT 65536 //different lines remembered for each template before starting over
+#define LINE_EMPTY       0    //kinds of line found by the parallel pass
+#define LINE_DIRECTIVE   1
+#define LINE_DATA        2
+#define LINE_CODE        3
+#define LINE_BAD         4    //an instruction that could not be encoded, reported again in order
+
+#define SYMBOL_NONE      0    //what a name in an operand turns out to be
+#define SYMBOL_LABEL     1    //a label, or a symbol of another object
+#define SYMBOL_CONSTANT  2    //an equ constant or system variable, its value takes the place of the name
+
+#define PAGE_SIZE        256  //a table indexed by l alone has to stay within one of these
+#define PAGE_NO_CROSS    0    //kinds of page check
+#define PAGE_START       1
+
+#define BUDGET_CYCLES    0    //kinds of budget check
+#define BUDGET_SIZE      1
+
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <sstream>
+#include <unordered_map>
 #include <vector>
 #include "bs_util.hpp"
+#include "expression.hpp"
+#include "mapped_file.hpp"
+#include "object_file.hpp"
+#include "token_ir.hpp"
 using namespace std;
 
+struct section
+{
+    string name;
+    int    address; //where the next byte of the section goes on the foreign machine
+    bool   fixed;   //given an address by org or section, so a linker leaves it where it is
+};
+
+//what the parallel pass learned about a line, its bytes are in the buffer of its chunk
+struct line_code
+{
+    int kind;
+    int first;  //index of its first byte in the chunk buffer
+    int length;
+    int cycles; //T-states, the longest when the instruction can take two times
+    int placed; //index of its first byte in outbytes once addresses are worked out
+    int fixup;  //how the operand is patched once the symbol it names is known, FIXUP_NONE for numbers
+    int name;   //id of that symbol in the tokens, -1 when it is only known by symbol
+    string symbol;
+};
+
+//a name the assembler knows, a label from the preprocessor or a constant
+struct symbol_entry
+{
+    int label; //position in labels, -1 for a constant
+    int value; //value of a constant
+};
+
+//what assemble_line made of a line, the operand slot says how the bytes are patched once its symbol is known
+struct cached_encoding
+{
+    vector<int> bytes;
+    int fixup;
+    int cycles;
+};
+
+//a line of tokens with any symbol operand left out, lines of the same shape encode the same way
+struct line_shape
+{
+    int mnemonic;
+    int kinds;  //both operand kinds, and which of them is the symbol
+    int value1;
+    int value2;
+    
+    bool operator==(const line_shape &other) const
+    {
+        return mnemonic == other.mnemonic && kinds == other.kinds && value1 == other.value1 && value2 == other.value2;
+    }
+};
+
+struct line_shape_hash
+{
+    size_t operator()(const line_shape &shape) const
+    {
+        return ((size_t)shape.mnemonic * 31 + shape.kinds) * 1000003 + (size_t)shape.value1 * 8191 + shape.value2;
+    }
+};
+
+//bytes in outbytes that wait for the value of a label, or of a symbol from another object
+struct fixup_site
+{
+    int kind;
+    int at;     //index of the first byte in outbytes
+    int next;   //address after the instruction, displacements are counted from here
+    int name;   //id of the symbol in the tokens, -1 when it is only known by symbol
+    string symbol;
+};
+
+//a label block that page or nopagecross says has to stay within one page
+struct page_check
+{
+    int kind;
+    int line;    //line of the directive, the block is the label before it up to the next label
+    int section;
+    int start;   //address at the directive, used when no label of its section comes before it
+    int end;     //address after the last byte of the block, -1 until the next label closes it
+};
+
+//a label block that assert_cycles or assert_size gives a budget
+struct budget_check
+{
+    int kind;
+    string where; //line of the directive, as errors show it
+    int label;    //position in labels, -1 until a label streamed in after the directive is looked up
+    int limit;
+    string name;  //name of the label
+};
+
+//a run of bytes that were assembled one after another into the same section
+struct region
+{
+    int section; //index into the section list
+    int address; //memory location of the first byte on the foreign machine
+    int first;   //index of the first byte in outbytes
+    int length;
+    const uchar* data; //bytes that live outside of outbytes, such as an incbin file, otherwise null
+};
+
 class assembler
 {
-    int version = 0x0;     //template file version
+    int version = 0x2;     //template file version
     string filename_tpl;   //filename of template for displaying errors
-    ifstream stream_tpl;   //file stream for template
+    istringstream stream_tpl; //template, read whole from the file once per run of the program
+    bool tpl_open;         //true if the template could be read
     int tpl_inst_count;    //number of instructions available in the template file
+    long long tpl_scans;   //template scans made by this assembler, other threads scan at the same time
+    bool quiet;            //errors are not shown, used by the threads that encode in parallel
+    int thread_count;      //threads used to encode instructions, one encodes on the calling thread
+    string entry_label;    //when set, blocks that cannot be reached from this label are left out
+    bool relocatable;      //names that are not labels are taken as symbols of other objects, nothing is patched
+    int operand_fixup;     //how the last instruction resolved should be patched, FIXUP_NONE if it needs nothing
+    string operand_symbol; //name its operand used, when it was spelled out
+    int operand_name;      //id of that name in the tokens instead, -1 when it was not taken from them
+    bool streaming;        //lines are assembled a batch at a time and their bytes moved out to spill
+    fstream spill;         //every byte assembled so far, in the order of outbytes, while streaming
+    string spill_file;
+    int spilled;           //bytes moved out to spill, the index in outbytes of the first byte still held
+    bool started;          //the template was checked, and spill opened when streaming
+    int line_count;        //lines assembled so far, which is the number of the last one
+    int error_count;       //errors found so far, nothing more is assembled after one
+    int next_label_line;   //line of the next label to be placed, zero once every label taken so far is
     
     string filename_inst;  //filename of source file for displaying errors
-    ifstream stream_inst;  //file stream for instructions
+    ifstream stream_inst;  //file stream for instructions, read when the preprocessor did not hand over its tokens
+    const token_ir* tokens; //lines being assembled, from the preprocessor or read from stream_inst
+    token_ir batch;        //lines read from stream_inst
+    bool tokens_read;      //the tokens handed over were assembled, they make up a single batch
+    int token_base;        //line number before the first line of tokens
+    unordered_map<line_shape, cached_encoding, line_shape_hash> shapes; //lines this assembler has encoded from tokens
+    vector<signed char> name_classes; //SYMBOL_ kind of each name id, -1 until it is asked
+    vector<int> name_values;          //value of each name id that is a constant
 
     int inst_prefix;       //instruction prefix byte
     int inst_value;        //instruction value byte
+    int inst_index;        //index register prefix byte, 0xDD for ix and 0xFD for iy
+    int inst_cycles;       //T-states the instruction takes, the longest for one that can take two times
     int start_address;     //mem location of first byte of assembled code on the foreign machine
-    int byte_count;        //output-byte count; increases through program execution and is used for address calculation
+    int crnt_section;      //section that assembled bytes are going into
+    int byte_count;        //output-byte count; increases through program execution across every section
+    long long cycle_count; //T-states of every instruction assembled so far, each counted once
     bool line_is_label;    //if the line we are on is a label, then this will be true
     vector<int> outbytes;  //assembled instructions
     vector<label*> labels; //location of preprocessor's labels
+    unordered_map<string, symbol_entry> symbols; //every label and constant by name
+    const expr_symbols* constants; //equ constants and system variables, for table expressions
+    vector<section> sections;
+    vector<region> regions; //in the order they were assembled, not by address
+    vector<mapped_file*> binaries; //files brought in by incbin, kept open until output is written
+    vector<fixup_site> fixups;
+    vector<int> label_sections;    //section each label was placed in
+    vector<page_check> page_checks;
+    vector<int> label_bytes;       //byte_count and cycle_count when each label was placed
+    vector<long long> label_cycles;
+    vector<budget_check> budget_checks;
 
     //gets information out of instruction file
     void read(string instruction, string &mnem, string &arg1, string &arg2);
@@ -72,19 +242,142 @@ class assembler
     //changes constants to a specified placeholder for template scans
     void adjust_values(int pass, string* arg);
 
+    //changes an indexed argument such as (ix+5) to its template class and gets the displacement out of it
+    bool adjust_index(string* arg, int &disp);
+
     //attempts alternatives if a single scan cannot decide how to assemble an instruction
     bool resolve_instruction(int &error_amount, int &line_num, string mnem, string arg1, string arg2);
     
+    //classifies and encodes lines from up to to of tokens with encoder, which is only used by one thread at a time
+    void encode_chunk(assembler* encoder, int from, int to, vector<line_code> &codes, vector<uchar> &buffer);
+    
+    //empties the lines of label blocks that no call, jump, or other label use reaches from entry_label
+    bool remove_unreachable(vector<vector<line_code> > &codes);
+    
+    //encodes a line of lines, only spelling it out for assemble_line the first time its shape is seen
+    bool assemble_tokens(const token_ir &lines, int line, vector<int> &bytes);
+    
+    //bytes a db, dw, ds, or incbin line would add
+    int data_length(string line);
+    
+    //the operand of an instruction that names a symbol is patched later, at is the first byte of the instruction
+    //the symbol is given as an id in the tokens when it has one, and by name otherwise
+    void note_fixup(int kind, int at, int length, int name, const string &symbol);
+    
+    //name of the symbol a fixup is patched with
+    const string &fixup_symbol(const fixup_site &f) const;
+    
+    //true for a label, or for a name another object could define when assembling an object
+    bool is_symbol(string name);
+    
+    //true if an argument, or what it points to, is a symbol
+    bool names_symbol(const string &arg);
+    
+    //SYMBOL_ kind of a name id of lines, worked out once for each id
+    int name_class(const token_ir &lines, int id);
+    
+    //replaces an argument that is a constant, or points to one, with its value
+    void substitute_constant(string &arg);
+    
+    //stands in for a symbol argument in the key of a remembered line
+    static string symbol_slot(const string &arg);
+    
+    //patches every fixup with the address of its label, reporting names that are not labels
+    void resolve_fixups(int &error_amount);
+    
+    //points tokens at the lines to assemble, returns false when they were already assembled
+    bool read_lines();
+    
+    //checks the template, and opens spill when streaming, returns false if nothing can be assembled
+    bool start();
+    
+    //assembles the lines of tokens after every line before them, returns false if entry_label cannot be found
+    bool assemble_lines();
+    
+    //patches fixups and runs the checks once every line is assembled
+    void finish();
+    
+    //takes the labels of table after the ones already taken, a batch of lines is given every label found so far
+    void add_labels(const vector<label*> &table);
+    
+    //moves the bytes held in outbytes out to spill, which is the only place they are kept from then on
+    void spill_bytes();
+    
+    //bytes from first in the order of outbytes, wherever they are kept
+    string stored_bytes(int first, int count);
+    
+    //changes an assembled byte after it was placed, with a positioned write when it was spilled
+    void patch_byte(int at, int value);
+    
+    //reports every page or nopagecross block that crosses a page, or does not start one for page
+    void check_pages(int &error_amount);
+    
+    //reports every block that takes more T-states or bytes than assert_cycles or assert_size allows
+    void check_budgets(int &error_amount);
+    
+    //handles org, section, page, nopagecross, assert_cycles, and assert_size lines, returns true if the line was one of them
+    bool process_directive(int &error_amount, int &line_num, string mnem, string arg1, string arg2);
+
+    //handles db, dw, ds, align, and incbin lines, returns false if there was an error
+    bool process_data(int &error_amount, int &line_num, string mnem, string arg1, string arg2);
+
+    //adds a dbtable or dwtable, the value of an expression for every index from first to last
+    void generate_table(const vector<string> &items, bool words, string &err_msg);
+
+    //splices part of a file into the current section without copying it into outbytes
+    bool include_binary(string file, int offset, int length, string &err_msg);
+
+    //writes count bytes of a region starting from its byte at from
+    void write_region(ostream &out, const region &r, int from, int count);
+
+    //bytes after an org or a change of section go in a region of their own
+    void start_region();
+
+    //accounts for bytes pushed onto outbytes since first_byte in the current region and section
+    void place_bytes(int first_byte);
+
+    //returns regions that hold bytes sorted by address, reporting any that overlap or run out of memory
+    vector<region> memory_map(bool report);
+
     //sets memory addresses for each label found in the program
     void resolve_label_addresses(int &line_num, int &next_line);
 
+    //a line of the combined program, with the file and line it was written on when they are known
+    string line_location(int line_num);
+
     //to be called when an irrecoverrable error occurs
     void display_error(int line_num, string err_msg, string mnem, string arg1, string arg2);
 
     public:
+        bool errors_exist;                            //true if anything kept the program from assembling
         assembler(string instfile, string tplfile);
+        void take_tokens(const token_ir* lines);      //assemble lines lexed by the preprocessor instead of reading instfile
+        void set_threads(int count);                  //threads to encode with, zero for one per core
+        void set_entry(string label_name);            //leaves out blocks not reached from this label
+        void set_relocatable(bool on);                //assemble for export_object, leaving symbols for the linker
+        void set_streaming(bool on);                  //assemble in batches, keeping bytes in a file beside the source
+        bool export_object(string file);              //writes bytes, labels, and fixups for siasm-link
+        void add_bytes(string section_name, int address, const vector<uchar> &bytes); //places bytes made elsewhere
+        bool check_memory_map() { memory_map(true); return !errors_exist; } //reports overlaps, as run does
+        static void forget_template(string file);     //reads the template again next time and forgets lines encoded with it
+        ~assembler();
         void take_label_table(vector<label*>* table); //gets location of label table for us to use
+        void take_constants(const expr_symbols* table); //names that stand for numbers, taken after the labels
         void run();                                   //main function of the assembler, this does the work
+        bool assemble_batch(const token_ir* lines, const vector<label*> &table, const expr_symbols &found); //instead of run, false after an error
+        void finish_batches();                        //once the last batch of a stream is assembled
+        void display_results();                       //shows assembled values and labels on the console
+        void export_to_file(string file);             //writes assembled values to a binary image
+        void write_image(ostream &out);               //the same image written to any stream
+        int  image_address();                         //lowest populated address, where the image starts
+        void populated_ranges(vector<int> &starts, vector<int> &lengths); //address and length of every run of bytes
+        void export_sparse(string file);              //writes only populated ranges, each with its address
+        void display_memory_map(ostream &out);        //lists every populated range and its section
+        bool export_memory_map(string file);          //writes the memory map to a text file, false if it could not be written
+        int  output_size() { return byte_count; }
+        vector<string> binary_files();                //every file brought in by incbin
+        bool assemble_line(string instline, vector<int> &bytes); //assembles a single line outside of run, remembering it
+        static const char* argument_spelling(int arg);           //returns template spelling of an argument class
 };
 
 #endif
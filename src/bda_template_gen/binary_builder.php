@@ -64,6 +64,8 @@ class argument_combo
     private $argument2;
     private $value;
     private $prefix;
+    private $index;
+    private $cycles;
     
     private $table = array(
         "",   "N",    "NN", "(NN)", "DIS", ":",
@@ -72,15 +74,18 @@ class argument_combo
         "sp", "(sp)", "i",  "r",    "(c)",
         "nz", "z",    "nc", "po",   "pe",  "p",  "m",
         "0",  "1",    "2",  "3",    "4",   "5",  "6",   "7",    "8",
-        "16", "24",   "32", "40",   "48",  "56"
+        "16", "24",   "32", "40",   "48",  "56",
+        "ix", "iy",   "(ix)", "(iy)", "(ix+DIS)", "(iy+DIS)"
     );
     
-    function __construct($arg1, $arg2, $val, $pfx)
+    function __construct($arg1, $arg2, $val, $pfx, $idx, $cyc)
     {
         $this->argument1 = $this->table_of_arguments($arg1);
         $this->argument2 = $this->table_of_arguments($arg2);
         $this->value = $val;
         $this->prefix = $pfx;
+        $this->index = $idx;
+        $this->cycles = $cyc;
     }
     
     function table_of_arguments($arg)
@@ -109,6 +114,8 @@ class argument_combo
             . chr($this->argument2)
             . chr($this->value)
             . chr($this->prefix)
+            . chr($this->index)
+            . chr($this->cycles)
         );
     }
 }
@@ -164,7 +171,7 @@ function starting_procedure($filename)
     $argument1 =  "";
     $argument2 =  "";
     
-    $version =    0;
+    $version =    2;
     $inst_count = 0;
     
     $conn = new mysqli($servername,$username,$password,$dbname);
@@ -209,7 +216,7 @@ function starting_procedure($filename)
                 LENGTH(`mnemonic`) = $item_len
                 OR SUBSTRING(`mnemonic`, ".($item_len+1).",1) = ' '
             )
-            ORDER BY `prefix_byte`, `code`"
+            ORDER BY `index_byte`, `prefix_byte`, `code`"
         );
         
         if ($res->num_rows > 0)
@@ -220,7 +227,7 @@ function starting_procedure($filename)
                 $argument1 = "";
                 $argument2 = "";
                 tokenize_user_inst($row["mnemonic"],$mnemonic,$argument1,$argument2);
-                $arg = new argument_combo($argument1,$argument2,$row["code"],$row["prefix_byte"]);
+                $arg = new argument_combo($argument1,$argument2,$row["code"],$row["prefix_byte"],$row["index_byte"],$row["cycles"]);
                 $obj->add_arg_combo($arg);
             }
         }
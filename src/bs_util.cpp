@@ -21,6 +21,8 @@
 ==============================================================================================*/
 
 #include "bs_util.hpp"
+#include "lexer.hpp"
+#include <cctype>
 
 int bs_util::num_get_msb(int value)
 {
@@ -62,66 +64,24 @@ bool bs_util::can_be_signed_one_byte_value(int value)
 
 string bs_util::trim_left(string input)
 {
-    int iter = 0;
-    char c = input[0];
-    bool start_collecting = false;
-    string output = "";
-    
-    if (input == "") return input;
-    
-    while (iter < input.length())
-    {
-        if (!start_collecting)
-        {
-            if (c != ' ' && c != '\t')
-            {
-                start_collecting = true;
-                output += c;
-            }
-        }
-        else output += c;
-        
-        iter++;
-        c = input[iter];
-    }
-    
-    return output;
+    return input.substr(lexer::skip(input.data(), 0, input.length(), ' ', '\t'));
 }
 
 string bs_util::trim_right(string input)
 {
-    int iter = 0;
-    int len = input.length();
-    char c = input[len-1];
-    bool start_collecting = false;
-    string output = "";
-
-    if (input == "") return input;
+    int end = input.length();
     
-    while (iter < len)
-    {
-        if (!start_collecting)
-        {
-            if (c != ' ' && c != '\t')
-            {
-                start_collecting = true;
-                output = c + output;
-            }
-        }
-        else output = c + output;
-        
-        iter++;
-        c = input[len-iter-1];
-    }
+    while (end > 0 && (input[end-1] == ' ' || input[end-1] == '\t'))
+        end--;
     
-    return output;
+    input.resize(end);
+    return input;
 }
 
 string bs_util::trim(string input)
 {
-    input = trim_left(input);
-    input = trim_right(input);
-    return input;
+    span s = lexer::trim(input.data(), 0, input.length());
+    return input.substr(s.start, s.length);
 }
 
 bool bs_util::is_all_alphabetic(string input)
@@ -145,6 +105,20 @@ bool bs_util::is_all_alphabetic(string input)
     return output;
 }
 
+bool bs_util::is_name(string input)
+{
+    if (input.length() < 1 || !isalpha(input[0]))
+        return false;
+    
+    for (int i = 1; i < input.length(); i++)
+    {
+        if (!isalnum(input[i]) && input[i] != '_')
+            return false;
+    }
+    
+    return true;
+}
+
 bool bs_util::is_all_numeric(string input)
 {
     int i = 0;
@@ -214,3 +188,23 @@ string bs_util::remove_outer_chars(string input)
 {
     return input.substr(1,input.length()-2);
 }
+
+
+void bs_util::append_int(string &output, int value)
+{
+    char digits[12];
+    int count = 12;
+    unsigned int magnitude = (value < 0) ? -(unsigned int)value : value;
+    
+    do
+    {
+        digits[--count] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    }
+    while (magnitude > 0);
+    
+    if (value < 0)
+        digits[--count] = '-';
+    
+    output.append(digits + count, 12 - count);
+}
@@ -55,10 +55,12 @@ namespace bs_util
     string trim(string input);                      //trims only spaces from both sides of a string
     bool   is_all_alphabetic(string input);         //returns true if all characters are alphabetic
     bool   is_all_numeric(string input);            //returns true if all characters are numeric
+    bool   is_name(string input);                   //returns true for a letter followed by letters, digits, and underscores
     bool   is_pointer(string input);                //returns true if surrounded by parenthesis
     int    quad_str_to_int(string input);           //turns a string of four characters into an int
     string remove_non_numerics(string input);       //removes all characters that are not numeric
     string remove_outer_chars(string input);        //removes just outer characters
+    void   append_int(string &output, int value);  //appends the decimal spelling of value without a temporary
 }
 
 #endif
@@ -0,0 +1,132 @@
+/*==============================================================================================
+    
+    delta.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "delta.hpp"
+
+//called with bc holding its own address as USR does, copies every block of the patch that follows it into place
+static const char* patcher_loop[] = {
+    "ld e,(hl)",    //block address
+    "inc hl",
+    "ld d,(hl)",
+    "inc hl",
+    "ld c,(hl)",    //block length
+    "inc hl",
+    "ld b,(hl)",
+    "inc hl",
+    "ld a,b",
+    "or c",
+    "ret z",        //the zero block ends the patch
+    "ldir",         //leaves hl at the next block
+    "jr -15"
+};
+
+delta::delta(const string &previous, const string &current, int address)
+{
+    image = current;
+    image_start = address;
+    changed = 0;
+    
+    for (int at = 0; at < image.length(); )
+    {
+        if (at < previous.length() && previous[at] == image[at])
+        {
+            at++;
+            continue;
+        }
+        
+        delta_block block = { image_start + at, 0 };
+        int end = at;
+        
+        //the block runs on over short unchanged runs until a longer one, or the end of the image, is found
+        for (int same = 0; end < image.length() && same <= DELTA_MERGE_GAP && end - at < DELTA_BLOCK_LIMIT; end++)
+        {
+            if (end < previous.length() && previous[end] == image[end])
+                same++;
+            else
+            {
+                same = 0;
+                changed++;
+                block.length = end + 1 - at;
+            }
+        }
+        
+        blocks.push_back(block);
+        at += block.length;
+    }
+}
+
+void delta::write(ostream &out)
+{
+    for (int i = 0; i < blocks.size(); i++)
+    {
+        out.put((char)bs_util::num_get_lsb(blocks[i].address));
+        out.put((char)bs_util::num_get_msb(blocks[i].address));
+        out.put((char)bs_util::num_get_lsb(blocks[i].length));
+        out.put((char)bs_util::num_get_msb(blocks[i].length));
+        out.write(image.data() + blocks[i].address - image_start, blocks[i].length);
+    }
+    
+    for (int i = 0; i < 4; i++)
+        out.put((char)0);
+}
+
+bool delta::build_patcher(assembler* as, vector<uchar> &code)
+{
+    vector<int> bytes;
+    vector<uchar> loop;
+    
+    for (int i = 0; i < sizeof(patcher_loop) / sizeof(patcher_loop[0]); i++)
+    {
+        if (!as->assemble_line(patcher_loop[i], bytes))
+            return false;
+        
+        for (int j = 0; j < bytes.size(); j++)
+            loop.push_back(bytes[j]);
+    }
+    
+    //ld hl,nn and add hl,bc always take four bytes, the patch starts right after the loop
+    string prologue[2] = { "ld hl,", "add hl,bc" };
+    bs_util::append_int(prologue[0], 4 + loop.size());
+    code.clear();
+    
+    for (int i = 0; i < 2; i++)
+    {
+        if (!as->assemble_line(prologue[i], bytes))
+            return false;
+        
+        for (int j = 0; j < bytes.size(); j++)
+            code.push_back(bytes[j]);
+    }
+    
+    code.insert(code.end(), loop.begin(), loop.end());
+    return true;
+}
+
+int delta::size()
+{
+    int total = 4;
+    
+    for (int i = 0; i < blocks.size(); i++)
+        total += 4 + blocks[i].length;
+    
+    return total;
+}
@@ -0,0 +1,66 @@
+/*==============================================================================================
+    
+    delta.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Delta
+    10/19/26 - B.D.S.
+    Purpose: Compares an image with an earlier build and writes the bytes that changed as a patch.
+    
+==============================================================================================*/
+
+
+#ifndef _DELTA_HPP
+#define _DELTA_HPP
+
+#define DELTA_MERGE_GAP    4     //unchanged runs this short are sent again rather than starting a block, whose header is four bytes
+#define DELTA_BLOCK_LIMIT  65535 //block lengths are two bytes
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "assembler.hpp"
+#include "bs_util.hpp"
+using namespace std;
+
+//a range of the new image that differs from the old one
+struct delta_block
+{
+    int address;
+    int length;
+};
+
+class delta
+{
+    string image;               //new image from image_start
+    int image_start;
+    vector<delta_block> blocks;
+    int changed;                //bytes that differ, not counting unchanged ones sent along inside a block
+    
+    public:
+        delta(const string &previous, const string &current, int address); //both images start at address
+        void write(ostream &out);                           //blocks in the --sparse format, ending with a zero block
+        bool build_patcher(assembler* as, vector<uchar> &code); //routine that copies the patch after it into place
+        int  block_count() { return blocks.size(); }
+        int  changed_bytes() { return changed; }
+        int  size();                                         //bytes write puts out
+};
+
+#endif
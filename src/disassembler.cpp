@@ -0,0 +1,559 @@
+/*==============================================================================================
+    
+    disassembler.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "disassembler.hpp"
+#include <cstring>
+
+#define SAMPLE_N   90   //example values used when turning template rows back into source text
+#define SAMPLE_NN  4660
+#define SAMPLE_DIS -3
+
+#define SPELL_NONE 0 //tables of value spellings an opcode's operand can be written with
+#define SPELL_BYTE 1
+#define SPELL_DISP 2
+#define SPELL_WORD 3
+#define SPELL_INDEX 4 //displacements of indexed arguments, always signed
+
+static const char VALUE_MARK = '\1'; //stands in for the trailing value while building table text
+
+disassembler::disassembler(string tplfile)
+{
+    errors_exist = false;
+    filename_tpl = tplfile;
+    
+    for (int i = 0; i < DIS_PREFIX_COUNT; i++)
+    {
+        for (int j = 0; j < 256; j++)
+        {
+            table[i][j].valid = false;
+            table[i][j].length = 0;
+            table[i][j].next_table = DIS_PREFIX_NONE;
+            table[i][j].next_offset = 1;
+            table[i][j].head_length = 0;
+            table[i][j].middle_length = 0;
+            table[i][j].tail_length = 0;
+            
+            for (int k = 0; k < 2; k++)
+            {
+                table[i][j].offset[k] = 0;
+                table[i][j].mask[k] = 0;
+                table[i][j].spelling[k] = SPELL_NONE;
+            }
+        }
+    }
+    
+    table[DIS_PREFIX_NONE][0xCB].next_table = DIS_PREFIX_CB;
+    table[DIS_PREFIX_NONE][0xED].next_table = DIS_PREFIX_ED;
+    table[DIS_PREFIX_NONE][0xDD].next_table = DIS_PREFIX_DD;
+    table[DIS_PREFIX_NONE][0xFD].next_table = DIS_PREFIX_FD;
+    table[DIS_PREFIX_DD][0xCB].next_table = DIS_PREFIX_DDCB;
+    table[DIS_PREFIX_FD][0xCB].next_table = DIS_PREFIX_FDCB;
+    table[DIS_PREFIX_DD][0xCB].next_offset = 2; //DD CB d op, the opcode follows the displacement
+    table[DIS_PREFIX_FD][0xCB].next_offset = 2;
+    
+    if (load_template())
+        build_tables();
+    else
+        errors_exist = true;
+}
+
+bool disassembler::load_template()
+{
+    ifstream stream_tpl;
+    char read_buffer;
+    const short FORMAT_CHECK_SIZE = 5;
+    char format_check[FORMAT_CHECK_SIZE+1];
+    int inst_count;
+    
+    stream_tpl.open(filename_tpl.c_str(), ios::binary|ios::in);
+    
+    if (!stream_tpl.is_open())
+    {
+        cout << "File(s) could not be opened to read!" << endl;
+        return false;
+    }
+    
+    stream_tpl.read(format_check, sizeof(char)*FORMAT_CHECK_SIZE);
+    format_check[FORMAT_CHECK_SIZE] = '\0';
+    
+    if (string(format_check) != "siasm")
+    {
+        cout << filename_tpl << " is not of the correct format!" << endl;
+        return false;
+    }
+    
+    stream_tpl.get(read_buffer);
+    
+    if ((uchar)read_buffer != version)
+    {
+        cout << filename_tpl << " is outdated. Cannot continue!" << endl;
+        return false;
+    }
+    
+    stream_tpl.get(read_buffer);
+    inst_count = (uchar)read_buffer;
+    
+    for (int i = 0; i < inst_count; i++)
+    {
+        char inst_name[6];
+        int name_length;
+        int arg_combo_num;
+        const int ARG_BYTES = 6;
+        char arg_combo[ARG_BYTES];
+        
+        stream_tpl.get(read_buffer);
+        name_length = (read_buffer & 3) + 2; //length is the rightmost two bits, 00 = 2, 10 = 4
+        stream_tpl.read(inst_name, name_length);
+        inst_name[name_length] = '\0';
+        
+        stream_tpl.get(read_buffer);
+        arg_combo_num = (uchar)read_buffer;
+        
+        for (int j = 0; j < arg_combo_num; j++)
+        {
+            template_row row;
+            
+            stream_tpl.read(arg_combo, sizeof(char)*ARG_BYTES);
+            row.mnem = inst_name;
+            row.arg1 = (uchar)arg_combo[0];
+            row.arg2 = (uchar)arg_combo[1];
+            row.value = (uchar)arg_combo[2];
+            row.prefix = (uchar)arg_combo[3];
+            row.index = (uchar)arg_combo[4];
+            rows.push_back(row);
+        }
+        
+        if (!stream_tpl)
+        {
+            cout << filename_tpl << " ended before all instructions were read!" << endl;
+            return false;
+        }
+    }
+    
+    stream_tpl.close();
+    return true;
+}
+
+void disassembler::build_tables()
+{
+    for (int i = 0; i < rows.size(); i++)
+    {
+        template_row &row = rows[i];
+        int pi = prefix_index(row.prefix, row.index);
+        int args[2] = { row.arg1, row.arg2 };
+        int prefix_length = (row.prefix != 0) + (row.index != 0);
+        bool has_disp = (row.arg1 == ARG_IX_DIS || row.arg1 == ARG_IY_DIS || row.arg2 == ARG_IX_DIS || row.arg2 == ARG_IY_DIS);
+        int disp_offset = (row.index != 0 && row.prefix == 0xCB) ? prefix_length : prefix_length + 1;
+        int operand_offset = prefix_length + 1 + has_disp;
+        string text;
+        size_t mark[2];
+        
+        if (pi < 0 || table[pi][row.value].valid) //first spelling in the template wins
+            continue;
+        
+        opcode_entry &entry = table[pi][row.value];
+        entry.valid = true;
+        entry.length = operand_offset;
+        
+        //values are numbered in the order they are written, a displacement can come before an operand
+        for (int j = 0, k = 0; j < 2; j++)
+        {
+            switch (args[j])
+            {
+                case ARG_N: entry.offset[k] = operand_offset; entry.mask[k] = 0xFF; entry.spelling[k++] = SPELL_BYTE; entry.length += 1; break;
+                case ARG_DIS: entry.offset[k] = operand_offset; entry.mask[k] = 0xFF; entry.spelling[k++] = SPELL_DISP; entry.length += 1; break;
+                case ARG_NN: case ARG_PNN: entry.offset[k] = operand_offset; entry.mask[k] = 0xFFFF; entry.spelling[k++] = SPELL_WORD; entry.length += 2; break;
+                case ARG_IX_DIS: case ARG_IY_DIS: entry.offset[k] = disp_offset; entry.mask[k] = 0xFF; entry.spelling[k++] = SPELL_INDEX; break;
+            }
+        }
+        
+        text = row.mnem;
+        
+        if (row.arg1 != 0)
+            text += ' ' + argument_text(row.arg1, string(1, VALUE_MARK));
+        
+        if (row.arg2 != 0)
+            text += ", " + argument_text(row.arg2, string(1, VALUE_MARK));
+        
+        text += '\n';
+        mark[0] = text.find(VALUE_MARK);
+        mark[1] = (mark[0] == string::npos) ? string::npos : text.find(VALUE_MARK, mark[0] + 1);
+        
+        if (mark[0] == string::npos)
+            mark[0] = text.length();
+        
+        entry.head_length = mark[0];
+        
+        if (mark[1] != string::npos)
+        {
+            entry.middle_length = mark[1] - mark[0] - 1;
+            entry.tail_length = text.length() - mark[1] - 1;
+        }
+        else
+            entry.tail_length = (mark[0] < text.length()) ? text.length() - mark[0] - 1 : 0;
+        
+        if (entry.head_length > DIS_TEXT_SIZE || entry.middle_length > DIS_TEXT_SIZE || entry.tail_length > DIS_TEXT_SIZE)
+        {
+            cout << filename_tpl << " spells " << row.mnem << " too long to disassemble!" << endl;
+            entry.valid = false;
+            continue;
+        }
+        
+        text.copy(entry.head, entry.head_length, 0);
+        
+        if (entry.middle_length > 0)
+            text.copy(entry.middle, entry.middle_length, mark[0]+1);
+        
+        if (entry.tail_length > 0)
+            text.copy(entry.tail, entry.tail_length, text.length() - entry.tail_length);
+    }
+}
+
+int disassembler::prefix_index(int prefix, int index)
+{
+    switch ((index << 8) | prefix)
+    {
+        case 0x0000: return DIS_PREFIX_NONE;
+        case 0x00CB: return DIS_PREFIX_CB;
+        case 0x00ED: return DIS_PREFIX_ED;
+        case 0xDD00: return DIS_PREFIX_DD;
+        case 0xFD00: return DIS_PREFIX_FD;
+        case 0xDDCB: return DIS_PREFIX_DDCB;
+        case 0xFDCB: return DIS_PREFIX_FDCB;
+    }
+    
+    return -1;
+}
+
+string disassembler::argument_text(int arg, string value)
+{
+    switch (arg)
+    {
+        case ARG_N: case ARG_NN: case ARG_DIS: return value;
+        case ARG_PNN: return '(' + value + ')';
+        case ARG_IX_DIS: return "(ix" + value + ')';
+        case ARG_IY_DIS: return "(iy" + value + ')';
+    }
+    
+    return assembler::argument_spelling(arg);
+}
+
+//writes a value in decimal, only used to fill the spelling tables below
+static char* put_int(char* dst, int value)
+{
+    string digits;
+    
+    bs_util::append_int(digits, value);
+    digits.copy(dst, digits.length());
+    return dst + digits.length();
+}
+
+struct spelling
+{
+    char text[7];
+    uchar length;
+};
+
+//every value an operand can hold spelled out ahead of time, so decoding never divides or branches on it
+struct value_spellings
+{
+    spelling none[1];
+    spelling byte[256];
+    spelling disp[256];
+    spelling word[65536];
+    spelling index[256];
+    const spelling* kind[5];
+    
+    value_spellings()
+    {
+        none[0].length = 0;
+        
+        for (int i = 0; i < 65536; i++)
+        {
+            word[i].length = put_int(word[i].text, i) - word[i].text;
+            
+            if (i < 256)
+            {
+                byte[i].length = put_int(byte[i].text, i) - byte[i].text;
+                disp[i].length = put_int(disp[i].text, (signed char)i) - disp[i].text;
+                index[i].text[0] = '+'; //negative displacements bring their own sign
+                index[i].length = put_int(index[i].text + ((signed char)i >= 0), (signed char)i) - index[i].text;
+            }
+        }
+        
+        kind[SPELL_NONE] = none;
+        kind[SPELL_BYTE] = byte;
+        kind[SPELL_DISP] = disp;
+        kind[SPELL_WORD] = word;
+        kind[SPELL_INDEX] = index;
+    }
+};
+
+static const value_spellings values;
+
+inline char* disassembler::decode_into(const uchar* image, int size, int &pos, char* dst)
+{
+    int at = pos;
+    const opcode_entry* entry = &table[DIS_PREFIX_NONE][image[at]];
+    
+    //at most two prefixes deep, DD CB d op is the longest chain
+    if (entry->next_table != DIS_PREFIX_NONE && (at += entry->next_offset) < size)
+    {
+        entry = &table[entry->next_table][image[at]];
+        
+        if (entry->next_table != DIS_PREFIX_NONE && (at += entry->next_offset) < size)
+            entry = &table[entry->next_table][image[at]];
+    }
+    
+    if (!entry->valid || pos + entry->length > size)
+    {
+        //anything the template cannot spell is written as data, so the listing assembles back to the same bytes
+        memcpy(dst, "db ", 3);
+        dst += 3;
+        memcpy(dst, values.byte[image[pos]].text, 4);
+        dst += values.byte[image[pos]].length;
+        *dst++ = '\n';
+        pos++;
+        return dst;
+    }
+    
+    //reading two bytes at each offset is safe since decode_all keeps this path away from the end
+    const uchar* inst = image + pos;
+    const spelling* first = &values.kind[entry->spelling[0]][(inst[entry->offset[0]] | (inst[entry->offset[0]+1] << 8)) & entry->mask[0]];
+    const spelling* second = &values.kind[entry->spelling[1]][(inst[entry->offset[1]] | (inst[entry->offset[1]+1] << 8)) & entry->mask[1]];
+    
+    memcpy(dst, entry->head, DIS_TEXT_SIZE);
+    dst += entry->head_length;
+    memcpy(dst, first->text, sizeof(first->text));
+    dst += first->length;
+    memcpy(dst, entry->middle, DIS_TEXT_SIZE);
+    dst += entry->middle_length;
+    memcpy(dst, second->text, sizeof(second->text));
+    dst += second->length;
+    memcpy(dst, entry->tail, DIS_TEXT_SIZE);
+    dst += entry->tail_length;
+    pos += entry->length;
+    return dst;
+}
+
+int disassembler::decode(const uchar* image, int size, int pos, string &out)
+{
+    uchar padded[8] = { 0 };
+    char line[DIS_TEXT_SIZE*3];
+    int count = (size - pos < 4) ? size - pos : 4;
+    char* end;
+    
+    //an instruction is at most four bytes, copying them keeps decode_into from reading past the image
+    //since a value read at the last byte takes one more
+    memcpy(padded, image + pos, count);
+    pos = 0;
+    end = decode_into(padded, count, pos, line);
+    out.append(line, end - line);
+    return pos;
+}
+
+void disassembler::decode_all(const uchar* image, int size, ostream &out)
+{
+    const int FLUSH_SIZE = 1 << 16; //listing is written out in blocks rather than built whole
+    vector<char> listing(FLUSH_SIZE + DIS_TEXT_SIZE*3);
+    char* start = &listing[0];
+    char* dst = start;
+    int pos = 0;
+    
+    while (pos < size)
+    {
+        if (pos + 5 <= size) //four instruction bytes and the extra one a value read takes
+            dst = decode_into(image, size, pos, dst);
+        else
+        {
+            string last;
+            pos += decode(image, size, pos, last);
+            last.copy(dst, last.length());
+            dst += last.length();
+        }
+        
+        if (dst - start >= FLUSH_SIZE)
+        {
+            out.write(start, dst - start);
+            dst = start;
+        }
+    }
+    
+    out.write(start, dst - start);
+}
+
+bool disassembler::run(string binfile, string outfile)
+{
+    ifstream stream_bin;
+    vector<uchar> image;
+    int size;
+    
+    if (errors_exist)
+        return false;
+    
+    stream_bin.open(binfile.c_str(), ios::binary|ios::in);
+    
+    if (!stream_bin.is_open())
+    {
+        cout << "File(s) could not be opened to read!" << endl;
+        return false;
+    }
+    
+    stream_bin.seekg(0, stream_bin.end);
+    size = stream_bin.tellg();
+    stream_bin.seekg(0, stream_bin.beg);
+    image.resize(size);
+    
+    if (size > 0)
+        stream_bin.read((char*)&image[0], size);
+    
+    stream_bin.close();
+    
+    if (outfile == "")
+    {
+        if (size > 0)
+            decode_all(&image[0], size, cout);
+    }
+    else
+    {
+        ofstream outstream;
+        outstream.open(outfile.c_str(), ios::binary|ios::out);
+        
+        if (!outstream.is_open())
+        {
+            cout << outfile << " could not be opened to write!" << endl;
+            return false;
+        }
+        
+        if (size > 0)
+            decode_all(&image[0], size, outstream);
+        
+        outstream.close();
+    }
+    
+    return true;
+}
+
+string disassembler::sample_instruction(const template_row &row)
+{
+    string text = row.mnem;
+    int args[2] = { row.arg1, row.arg2 };
+    
+    for (int i = 0; i < 2 && args[i] != 0; i++)
+    {
+        string value;
+        
+        switch (args[i])
+        {
+            case ARG_N: bs_util::append_int(value, SAMPLE_N); break;
+            case ARG_NN: case ARG_PNN: bs_util::append_int(value, SAMPLE_NN); break;
+            case ARG_DIS: bs_util::append_int(value, SAMPLE_DIS); break;
+            case ARG_IX_DIS: case ARG_IY_DIS:
+                value = (SAMPLE_DIS < 0) ? "" : "+";
+                bs_util::append_int(value, SAMPLE_DIS);
+            break;
+        }
+        
+        text += (i == 0) ? " " : ", ";
+        text += argument_text(args[i], value);
+    }
+    
+    return text;
+}
+
+void disassembler::sample_bytes(const template_row &row, vector<uchar> &image)
+{
+    bool has_disp = (row.arg1 == ARG_IX_DIS || row.arg1 == ARG_IY_DIS || row.arg2 == ARG_IX_DIS || row.arg2 == ARG_IY_DIS);
+    
+    if (row.index != 0)
+        image.push_back(row.index);
+    
+    if (row.prefix != 0)
+        image.push_back(row.prefix);
+    
+    if (has_disp && row.prefix == 0xCB) //DD CB d op
+        image.push_back((uchar)SAMPLE_DIS);
+    
+    image.push_back(row.value);
+    
+    if (has_disp && row.prefix != 0xCB)
+        image.push_back((uchar)SAMPLE_DIS);
+    
+    if (row.arg1 == ARG_N || row.arg2 == ARG_N)
+        image.push_back(SAMPLE_N);
+    else if (row.arg1 == ARG_DIS || row.arg2 == ARG_DIS)
+        image.push_back((uchar)SAMPLE_DIS);
+    else if (row.arg1 == ARG_NN || row.arg2 == ARG_NN || row.arg1 == ARG_PNN || row.arg2 == ARG_PNN)
+    {
+        image.push_back(bs_util::num_get_lsb(SAMPLE_NN));
+        image.push_back(bs_util::num_get_msb(SAMPLE_NN));
+    }
+}
+
+int disassembler::roundtrip(assembler* as)
+{
+    int failures = 0;
+    
+    for (int i = 0; i < rows.size(); i++)
+    {
+        template_row &row = rows[i];
+        string text = sample_instruction(row);
+        string decoded;
+        vector<int> encoded;
+        vector<uchar> image;
+        
+        if (prefix_index(row.prefix, row.index) < 0)
+            continue;
+        
+        //the bytes the template itself describes for this row must decode back to the row
+        sample_bytes(row, image);
+        
+        if (decode(&image[0], image.size(), 0, decoded) != image.size() || decoded != text + '\n')
+        {
+            cout << "Round-trip error, template row " << i << " -> decodes as " << decoded;
+            failures++;
+            continue;
+        }
+        
+        //and whatever the assembler chooses for the row's source text must decode back to it too
+        if (!as->assemble_line(text, encoded))
+        {
+            cout << "Round-trip error, template row " << i << " -> could not assemble " << text << endl;
+            failures++;
+            continue;
+        }
+        
+        image.clear();
+        decoded.clear();
+        
+        for (int j = 0; j < encoded.size(); j++)
+            image.push_back((uchar)encoded[j]);
+        
+        if (decode(&image[0], image.size(), 0, decoded) != image.size() || decoded != text + '\n')
+        {
+            cout << "Round-trip error, template row " << i << " -> " << text << " decodes as " << decoded;
+            failures++;
+        }
+    }
+    
+    return failures;
+}
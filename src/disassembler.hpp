@@ -0,0 +1,102 @@
+/*==============================================================================================
+    
+    disassembler.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Disassembler
+    10/19/26 - B.D.S.
+    Purpose: Converts values back into instructions using the same template file.
+    
+==============================================================================================*/
+
+#ifndef _DISASSEMBLER_HPP
+#define _DISASSEMBLER_HPP
+
+#define DIS_PREFIX_NONE  0
+#define DIS_PREFIX_CB    1
+#define DIS_PREFIX_ED    2
+#define DIS_PREFIX_DD    3 //ix instructions
+#define DIS_PREFIX_FD    4 //iy instructions
+#define DIS_PREFIX_DDCB  5 //ix bit instructions, the displacement comes before the opcode
+#define DIS_PREFIX_FDCB  6
+#define DIS_PREFIX_COUNT 7
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "assembler.hpp"
+#include "bs_util.hpp"
+using namespace std;
+
+struct template_row
+{
+    string mnem;   //mnemonic spelling
+    int    arg1;   //argument classes as numbered by assembler::table_of_arguments
+    int    arg2;
+    int    value;  //opcode byte
+    int    prefix; //opcode prefix byte, zero when there is none
+    int    index;  //index register prefix byte, zero when there is none
+};
+
+#define DIS_TEXT_SIZE 16 //room for the longest spelling between values, copied whole for speed
+
+struct opcode_entry
+{
+    bool   valid;                 //false if the template has nothing for this opcode
+    int    length;                //total bytes of the instruction including prefixes and operands
+    int    offset[2];             //where each value is found, counted from the first prefix byte
+    int    mask[2];               //keeps only the bytes of a value out of the two read at its offset
+    int    spelling[2];           //which table of value spellings each value is written with
+    int    next_table;            //for prefix bytes, the table the following opcode is found in
+    int    next_offset;           //bytes from a prefix to the opcode it selects, two past a displacement
+    int    head_length;
+    int    middle_length;
+    int    tail_length;
+    char   head[DIS_TEXT_SIZE];   //text before the first value, or the whole line when there is none
+    char   middle[DIS_TEXT_SIZE]; //text between the two values
+    char   tail[DIS_TEXT_SIZE];   //text after the last value, including the line break
+};
+
+class disassembler
+{
+    int version = 0x2;                                  //template file version
+    string filename_tpl;                                //filename of template for displaying errors
+    vector<template_row> rows;                          //every argument combination in the template
+    opcode_entry table[DIS_PREFIX_COUNT][256];          //direct-indexed decode table for each prefix
+
+    bool load_template();                               //reads the whole template file into rows
+    void build_tables();                                //fills decode tables from the rows
+    int  prefix_index(int prefix, int index);           //maps prefix bytes to their table, -1 if none
+    void sample_bytes(const template_row &row, vector<uchar> &image); //machine code for sample_instruction
+    string argument_text(int arg, string value);        //spells an argument with a value substituted in
+    char* decode_into(const uchar* image, int size, int &pos, char* dst); //hot path of decode, no bounds on dst
+
+    public:
+        bool errors_exist;
+        disassembler(string tplfile);
+        int  decode(const uchar* image, int size, int pos, string &out); //appends one line, returns bytes used
+        void decode_all(const uchar* image, int size, ostream &out);     //decodes an entire image
+        bool run(string binfile, string outfile);                        //disassembles a file to a file or console
+        string sample_instruction(const template_row &row);             //source text for a row with example values
+        int  roundtrip(assembler* as);                                   //encodes and decodes every row, returns failures
+        const vector<template_row>& template_rows() { return rows; }
+};
+
+#endif
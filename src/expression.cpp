@@ -0,0 +1,413 @@
+/*==============================================================================================
+    
+    expression.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "expression.hpp"
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+struct binary_operator
+{
+    const char* spelling;
+    int level;
+    int op;
+};
+
+//longer spellings first so << is not taken for something else
+static const binary_operator binary_operators[] = {
+    { "<<", 3, EXPR_SHL }, { ">>", 3, EXPR_SHR },
+    { "|", 0, EXPR_OR },   { "^", 1, EXPR_XOR },  { "&", 2, EXPR_AND },
+    { "+", 4, EXPR_ADD },  { "-", 4, EXPR_SUB },
+    { "*", 5, EXPR_MUL },  { "/", 5, EXPR_DIV },  { "%", 5, EXPR_MOD }
+};
+
+static const char* function_names[] = { "sin", "cos", "sqrt", "abs", "int" }; //EXPR_SIN onwards
+
+bool expression::parse(string source, string &err_msg)
+{
+    steps.clear();
+    text = source;
+    at = 0;
+    parse_error = "";
+    
+    if (parse_level(0))
+    {
+        skip_spaces();
+        
+        if (at < text.length())
+            parse_error = "unexpected " + text.substr(at, 1) + " in " + text;
+    }
+    
+    err_msg = parse_error;
+    return parse_error == "";
+}
+
+bool expression::parse_level(int level)
+{
+    if (level == EXPR_LEVELS)
+        return parse_unary();
+    
+    if (!parse_level(level + 1))
+        return false;
+    
+    for (bool found = true; found; )
+    {
+        found = false;
+        skip_spaces();
+        
+        for (int i = 0; i < sizeof(binary_operators) / sizeof(binary_operators[0]) && !found; i++)
+        {
+            const binary_operator &b = binary_operators[i];
+            
+            if (b.level == level && text.compare(at, strlen(b.spelling), b.spelling) == 0)
+            {
+                at += strlen(b.spelling);
+                
+                if (!parse_level(level + 1))
+                    return false;
+                
+                push(b.op);
+                found = true;
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool expression::parse_unary()
+{
+    skip_spaces();
+    
+    if (at < text.length() && (text[at] == '-' || text[at] == '+' || text[at] == '~'))
+    {
+        char sign = text[at++];
+        
+        if (!parse_unary())
+            return false;
+        
+        if (sign != '+')
+            push((sign == '-') ? EXPR_NEGATE : EXPR_NOT);
+        
+        return true;
+    }
+    
+    return parse_operand();
+}
+
+bool expression::parse_operand()
+{
+    expr_step step = { EXPR_NUMBER, { false, 0, 0 }, "" };
+    int start;
+    
+    skip_spaces();
+    start = at;
+    
+    if (at >= text.length())
+    {
+        parse_error = text + " ends before an operand";
+        return false;
+    }
+    
+    if (text[at] == '(')
+    {
+        at++;
+        
+        if (!parse_level(0))
+            return false;
+        
+        skip_spaces();
+        
+        if (at >= text.length() || text[at] != ')')
+        {
+            parse_error = "missing ) in " + text;
+            return false;
+        }
+        
+        at++;
+        return true;
+    }
+    
+    if (isdigit(text[at]))
+    {
+        while (at < text.length() && isdigit(text[at]))
+            at++;
+        
+        //a decimal point makes the number real
+        if (at + 1 < text.length() && text[at] == '.' && isdigit(text[at + 1]))
+        {
+            for (at++; at < text.length() && isdigit(text[at]); )
+                at++;
+            
+            step.value.real = true;
+            step.value.number = atof(text.substr(start, at - start).c_str());
+        }
+        else
+        {
+            errno = 0;
+            step.value.whole = strtoll(text.substr(start, at - start).c_str(), NULL, 10);
+            
+            if (errno == ERANGE)
+            {
+                parse_error = text.substr(start, at - start) + " is out of range";
+                return false;
+            }
+        }
+        
+        steps.push_back(step);
+        return true;
+    }
+    
+    if (!isalpha(text[at]) && text[at] != '_')
+    {
+        parse_error = "unexpected " + text.substr(at, 1) + " in " + text;
+        return false;
+    }
+    
+    while (at < text.length() && (isalnum(text[at]) || text[at] == '_'))
+        at++;
+    
+    step.name = text.substr(start, at - start);
+    skip_spaces();
+    
+    if (at < text.length() && text[at] == '(')
+    {
+        int function = -1;
+        
+        for (int i = 0; i < sizeof(function_names) / sizeof(function_names[0]); i++)
+        {
+            if (step.name == function_names[i])
+                function = EXPR_SIN + i;
+        }
+        
+        if (function < 0)
+        {
+            parse_error = step.name + " is not a function";
+            return false;
+        }
+        
+        if (!parse_operand()) //the bracketed argument
+            return false;
+        
+        push(function);
+        return true;
+    }
+    
+    if (step.name == "pi")
+    {
+        step.value.real = true;
+        step.value.number = acos(-1.0);
+    }
+    else
+        step.op = EXPR_SYMBOL;
+    
+    steps.push_back(step);
+    return true;
+}
+
+void expression::skip_spaces()
+{
+    while (at < text.length() && (text[at] == ' ' || text[at] == '\t'))
+        at++;
+}
+
+void expression::push(int op)
+{
+    expr_step step = { op, { false, 0, 0 }, "" };
+    steps.push_back(step);
+}
+
+bool expression::evaluate(const expr_symbols &symbols, expr_value &result, string &err_msg) const
+{
+    vector<expr_value> stack;
+    
+    for (int i = 0; i < steps.size(); i++)
+    {
+        const expr_step &s = steps[i];
+        
+        if (s.op == EXPR_NUMBER)
+        {
+            stack.push_back(s.value);
+            continue;
+        }
+        
+        if (s.op == EXPR_SYMBOL)
+        {
+            expr_symbols::const_iterator found = symbols.find(s.name);
+            
+            if (found == symbols.end())
+            {
+                err_msg = s.name + " is not defined";
+                return false;
+            }
+            
+            expr_value v = { false, found->second, 0 };
+            stack.push_back(v);
+            continue;
+        }
+        
+        expr_value &a = stack[stack.size() - ((s.op >= EXPR_ADD && s.op <= EXPR_XOR) ? 2 : 1)];
+        
+        if (s.op >= EXPR_ADD && s.op <= EXPR_XOR)
+        {
+            expr_value b = stack.back();
+            stack.pop_back();
+            
+            if (!a.real && !b.real)
+            {
+                if ((s.op == EXPR_DIV || s.op == EXPR_MOD) && b.whole == 0)
+                {
+                    err_msg = "division by zero";
+                    return false;
+                }
+                
+                if ((s.op == EXPR_SHL || s.op == EXPR_SHR) && (b.whole < 0 || b.whole > 62))
+                {
+                    err_msg = "shifts must be from 0 to 62 bits";
+                    return false;
+                }
+                
+                //the one quotient that does not fit is the most negative number divided by -1
+                bool overflow = (s.op == EXPR_DIV || s.op == EXPR_MOD) && a.whole == LLONG_MIN && b.whole == -1;
+                
+                switch (s.op)
+                {
+                    case EXPR_ADD: overflow = __builtin_add_overflow(a.whole, b.whole, &a.whole); break;
+                    case EXPR_SUB: overflow = __builtin_sub_overflow(a.whole, b.whole, &a.whole); break;
+                    case EXPR_MUL: overflow = __builtin_mul_overflow(a.whole, b.whole, &a.whole); break;
+                    case EXPR_DIV: if (!overflow) a.whole /= b.whole; break;
+                    case EXPR_MOD: if (!overflow) a.whole %= b.whole; break;
+                    case EXPR_SHL:
+                        overflow = a.whole > (LLONG_MAX >> b.whole) || a.whole < (LLONG_MIN >> b.whole);
+                        
+                        if (!overflow)
+                            a.whole = (long long)((unsigned long long)a.whole << b.whole);
+                    break;
+                    case EXPR_SHR: a.whole >>= b.whole; break;
+                    case EXPR_AND: a.whole &= b.whole; break;
+                    case EXPR_OR:  a.whole |= b.whole; break;
+                    case EXPR_XOR: a.whole ^= b.whole; break;
+                }
+                
+                if (overflow)
+                {
+                    err_msg = "out of range";
+                    return false;
+                }
+                
+                continue;
+            }
+            
+            if (s.op > EXPR_DIV)
+            {
+                err_msg = "%, <<, >>, &, |, and ^ need whole numbers";
+                return false;
+            }
+            
+            double x = a.real ? a.number : (double)a.whole;
+            double y = b.real ? b.number : (double)b.whole;
+            
+            if (s.op == EXPR_DIV && y == 0)
+            {
+                err_msg = "division by zero";
+                return false;
+            }
+            
+            a.real = true;
+            a.number = (s.op == EXPR_ADD) ? x + y : (s.op == EXPR_SUB) ? x - y : (s.op == EXPR_MUL) ? x * y : x / y;
+            continue;
+        }
+        
+        //the rest take one operand, which is replaced on the stack
+        if (s.op == EXPR_NOT && a.real)
+        {
+            err_msg = "~ needs a whole number";
+            return false;
+        }
+        
+        if (s.op == EXPR_NEGATE || s.op == EXPR_ABS || s.op == EXPR_NOT)
+        {
+            if (s.op == EXPR_NOT)
+                a.whole = ~a.whole;
+            else if (s.op == EXPR_NEGATE || (a.real ? a.number < 0 : a.whole < 0))
+            {
+                if (!a.real && a.whole == LLONG_MIN)
+                {
+                    err_msg = "out of range";
+                    return false;
+                }
+                
+                a.whole = -a.whole;
+                a.number = -a.number;
+            }
+            
+            continue;
+        }
+        
+        double x = a.real ? a.number : (double)a.whole;
+        
+        if (s.op == EXPR_SQRT && x < 0)
+        {
+            err_msg = "square root of a negative number";
+            return false;
+        }
+        
+        if (s.op == EXPR_INT)
+        {
+            if (!(fabs(x) < 9.2e18))
+            {
+                err_msg = "out of range";
+                return false;
+            }
+            
+            a.real = false;
+            a.whole = (long long)x;
+            continue;
+        }
+        
+        a.real = true;
+        a.number = (s.op == EXPR_SIN) ? sin(x) : (s.op == EXPR_COS) ? cos(x) : sqrt(x);
+    }
+    
+    result = stack.back();
+    return true;
+}
+
+long long expression::scaled(const expr_value &value, int fraction_bits)
+{
+    double x = value.number * (double)(1LL << fraction_bits);
+    
+    if (!value.real && (value.whole > (LLONG_MAX >> fraction_bits) || value.whole < (LLONG_MIN >> fraction_bits)))
+        return (value.whole < 0) ? -(1LL << 62) : (1LL << 62);
+    
+    if (!value.real)
+        return value.whole * (1LL << fraction_bits);
+    
+    //too large or not a number at all, either way out of range of anything it could be stored in
+    if (!(fabs(x) < 1e18))
+        return (x < 0) ? -(1LL << 62) : (1LL << 62);
+    
+    return llround(x);
+}
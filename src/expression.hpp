@@ -0,0 +1,96 @@
+/*==============================================================================================
+    
+    expression.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Expression
+    10/19/26 - B.D.S.
+    Purpose: Works out numbers from arithmetic on constants, symbols, and a few functions.
+    
+==============================================================================================*/
+
+#ifndef _EXPRESSION_HPP
+#define _EXPRESSION_HPP
+
+#define EXPR_NUMBER 0  //steps of an expression in postfix order
+#define EXPR_SYMBOL 1
+#define EXPR_NEGATE 2
+#define EXPR_NOT    3
+#define EXPR_ADD    4
+#define EXPR_SUB    5
+#define EXPR_MUL    6
+#define EXPR_DIV    7
+#define EXPR_MOD    8
+#define EXPR_SHL    9
+#define EXPR_SHR    10
+#define EXPR_AND    11
+#define EXPR_OR     12
+#define EXPR_XOR    13
+#define EXPR_SIN    14
+#define EXPR_COS    15
+#define EXPR_SQRT   16
+#define EXPR_ABS    17
+#define EXPR_INT    18
+
+#define EXPR_LEVELS 6  //precedence levels of binary operators, | binds loosest and * / % tightest
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+//whole numbers stay whole through arithmetic, as in C, until a real number or function joins in
+struct expr_value
+{
+    bool      real;
+    long long whole;
+    double    number;
+};
+
+//names an expression can use and their values
+typedef unordered_map<string, long long> expr_symbols;
+
+struct expr_step
+{
+    int        op;
+    expr_value value; //for EXPR_NUMBER
+    string     name;  //for EXPR_SYMBOL
+};
+
+class expression
+{
+    vector<expr_step> steps; //the expression in postfix order, worked out with a stack
+    string text;             //being parsed
+    int at;                  //next character of text to parse
+    string parse_error;
+    
+    bool parse_level(int level);          //a run of operands joined by operators of level or tighter
+    bool parse_unary();                   //-, +, or ~ in front of an operand
+    bool parse_operand();                 //number, symbol, function call, or bracketed expression
+    void skip_spaces();
+    void push(int op);
+    
+    public:
+        bool parse(string source, string &err_msg);   //compiles source, false with a message if it is not an expression
+        bool evaluate(const expr_symbols &symbols, expr_value &result, string &err_msg) const;
+        static long long scaled(const expr_value &value, int fraction_bits); //fixed point, real numbers rounded to nearest
+};
+
+#endif
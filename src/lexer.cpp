@@ -0,0 +1,204 @@
+/*==============================================================================================
+    
+    lexer.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "lexer.hpp"
+
+//intrinsics that are not inlined are slower than scanning a byte at a time, so unoptimized builds do that
+#if defined(__GNUC__) && defined(__OPTIMIZE__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LEXER_X86
+#endif
+
+typedef int (*scan_function)(const char* text, int from, int to, char a, char b, bool match);
+
+//match is true to find a or b, false to find anything else
+static int scan_scalar(const char* text, int from, int to, char a, char b, bool match)
+{
+    for (int i = from; i < to; i++)
+    {
+        if ((text[i] == a || text[i] == b) == match)
+            return i;
+    }
+    
+    return to;
+}
+
+#ifdef LEXER_X86
+__attribute__((target("sse2")))
+static int scan_sse2(const char* text, int from, int to, char a, char b, bool match)
+{
+    __m128i va = _mm_set1_epi8(a);
+    __m128i vb = _mm_set1_epi8(b);
+    unsigned flip = match ? 0 : 0xFFFF;
+    int i = from;
+    
+    for (; i + 16 <= to; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        unsigned found = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb))) ^ flip;
+        
+        if (found != 0)
+            return i + __builtin_ctz(found);
+    }
+    
+    return scan_scalar(text, i, to, a, b, match); //the last few characters
+}
+
+__attribute__((target("avx2")))
+static int scan_avx2(const char* text, int from, int to, char a, char b, bool match)
+{
+    __m256i va = _mm256_set1_epi8(a);
+    __m256i vb = _mm256_set1_epi8(b);
+    unsigned flip = match ? 0 : 0xFFFFFFFF;
+    int i = from;
+    
+    for (; i + 32 <= to; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+        unsigned found = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, va), _mm256_cmpeq_epi8(block, vb))) ^ flip;
+        
+        if (found != 0)
+            return i + __builtin_ctz(found);
+    }
+    
+    //the tail stays in this function, mixing in code built for plain SSE2 costs more than it saves
+    if (i + 16 <= to)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        unsigned found = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, _mm256_castsi256_si128(va)),
+                                                        _mm_cmpeq_epi8(block, _mm256_castsi256_si128(vb)))) ^ (flip & 0xFFFF);
+        
+        if (found != 0)
+            return i + __builtin_ctz(found);
+        
+        i += 16;
+    }
+    
+    for (; i < to; i++)
+    {
+        if ((text[i] == a || text[i] == b) == match)
+            return i;
+    }
+    
+    return to;
+}
+#endif
+
+static scan_function scan_for(int mode)
+{
+#ifdef LEXER_X86
+    if (mode == LEX_AVX2)
+        return scan_avx2;
+    
+    if (mode == LEX_SSE2)
+        return scan_sse2;
+#endif
+    
+    return scan_scalar;
+}
+
+//chosen before main so threads that encode never race to choose it
+static int scan_mode = lexer::best_mode();
+static scan_function scan = scan_for(scan_mode);
+
+int lexer::best_mode()
+{
+#ifdef LEXER_X86
+    __builtin_cpu_init();
+    
+    if (__builtin_cpu_supports("avx2"))
+        return LEX_AVX2;
+    
+    if (__builtin_cpu_supports("sse2"))
+        return LEX_SSE2;
+#endif
+    
+    return LEX_SCALAR;
+}
+
+int lexer::mode()
+{
+    return scan_mode;
+}
+
+void lexer::set_mode(int mode)
+{
+    scan_mode = (mode < LEX_SCALAR) ? LEX_SCALAR : (mode > best_mode()) ? best_mode() : mode;
+    scan = scan_for(scan_mode);
+}
+
+int lexer::find(const char* text, int from, int to, char a, char b)
+{
+    return scan(text, from, to, a, b, true);
+}
+
+int lexer::skip(const char* text, int from, int to, char a, char b)
+{
+    return scan(text, from, to, a, b, false);
+}
+
+int lexer::find_comment(const char* text, int from, int to)
+{
+    for (int i = find(text, from, to, '/', '/'); i < to; i = find(text, i + 1, to, '/', '/'))
+    {
+        if (i + 1 < to && text[i+1] == '/')
+            return i;
+    }
+    
+    return to;
+}
+
+span lexer::trim(const char* text, int from, int to)
+{
+    span s;
+    
+    //spaces at the end are few, so they are not worth a block at a time
+    from = skip(text, from, to, ' ', '\t');
+    
+    while (to > from && (text[to-1] == ' ' || text[to-1] == '\t'))
+        to--;
+    
+    s.start = from;
+    s.length = to - from;
+    return s;
+}
+
+span lexer::source_line(const char* text, int from, int to)
+{
+    span s;
+    
+    if (to > from && text[to-1] == '\r')
+        to--;
+    
+    s = trim(text, from, to);
+    return trim(text, s.start, find_comment(text, s.start, s.start + s.length));
+}
+
+void lexer::split_instruction(const char* text, int from, int to, span &mnem, span &arg1, span &arg2)
+{
+    int space = find(text, from, to, ' ', ' ');
+    int comma = (space < to) ? find(text, space + 1, to, ',', ',') : to;
+    
+    mnem = trim(text, from, space);
+    arg1 = trim(text, (space < to) ? space + 1 : to, comma);
+    arg2 = trim(text, (comma < to) ? comma + 1 : to, to);
+}
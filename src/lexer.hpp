@@ -0,0 +1,67 @@
+/*==============================================================================================
+    
+    lexer.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Lexer
+    10/19/26 - B.D.S.
+    Purpose: Finds line ends, comments, spaces, and commas in source text a block at a time.
+    
+==============================================================================================*/
+
+#ifndef _LEXER_HPP
+#define _LEXER_HPP
+
+#define LEX_SCALAR 0 //one byte at a time
+#define LEX_SSE2   1 //16 bytes at a time
+#define LEX_AVX2   2 //32 bytes at a time
+
+using namespace std;
+
+//a run of characters within a buffer, nothing is copied until a token is needed as a string
+struct span
+{
+    int start;
+    int length;
+};
+
+namespace lexer
+{
+    int  best_mode();                //widest scan this processor supports
+    int  mode();                     //scan in use, the best one unless set_mode said otherwise
+    void set_mode(int mode);         //forces a narrower scan, used by the benchmark to compare them
+    
+    //index of the first character from from up to to that is a or b, or to if there is none
+    int  find(const char* text, int from, int to, char a, char b);
+    
+    //index of the first character that is neither a nor b, or to if there is none
+    int  skip(const char* text, int from, int to, char a, char b);
+    
+    int  find_comment(const char* text, int from, int to); //index of the first // or to
+    span trim(const char* text, int from, int to);         //without spaces and tabs at either end
+    
+    //a line of source without its comment, spaces, tabs, or a carriage return from a CRLF file
+    span source_line(const char* text, int from, int to);
+    
+    //the mnemonic ends at the first space and the first argument at the next comma
+    void split_instruction(const char* text, int from, int to, span &mnem, span &arg1, span &arg2);
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*==============================================================================================
+    
+    linker.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "linker.hpp"
+#include <iostream>
+
+linker::linker()
+{
+    errors_exist = false;
+}
+
+linker::~linker()
+{
+    for (int i = 0; i < objects.size(); i++)
+        delete objects[i];
+}
+
+bool linker::add(string file)
+{
+    object_file* obj = new object_file();
+    
+    if (!obj->read(file))
+    {
+        delete obj;
+        errors_exist = true;
+        return false;
+    }
+    
+    objects.push_back(obj);
+    names.push_back(file);
+    return true;
+}
+
+bool linker::link(assembler* out)
+{
+    place_sections();
+    collect_symbols();
+    
+    for (int i = 0; i < objects.size(); i++)
+        patch(i);
+    
+    if (errors_exist)
+        return false;
+    
+    for (int i = 0; i < objects.size(); i++)
+    {
+        for (int j = 0; j < objects[i]->regions.size(); j++)
+        {
+            const obj_region &r = objects[i]->regions[j];
+            out->add_bytes(objects[i]->sections[r.section].name, r.address + moved[i][r.section], r.bytes);
+        }
+    }
+    
+    return out->check_memory_map();
+}
+
+void linker::place_sections()
+{
+    map<string, int> next; //address after the last byte given to each section name so far
+    
+    moved.assign(objects.size(), vector<int>());
+    
+    for (int i = 0; i < objects.size(); i++)
+    {
+        for (int j = 0; j < objects[i]->sections.size(); j++)
+        {
+            const obj_section &s = objects[i]->sections[j];
+            int start = next.count(s.name) ? next[s.name] : 0;
+            
+            moved[i].push_back(s.fixed ? 0 : start);
+            next[s.name] = s.fixed ? s.end : start + s.end;
+        }
+    }
+}
+
+void linker::collect_symbols()
+{
+    for (int i = 0; i < objects.size(); i++)
+    {
+        for (int j = 0; j < objects[i]->symbols.size(); j++)
+        {
+            const obj_symbol &s = objects[i]->symbols[j];
+            
+            if (s.section == OBJ_IMPORT)
+                continue;
+            
+            if (defined_in.count(s.name) > 0)
+            {
+                cout << "Link error, " << s.name << " is defined in both " << defined_in[s.name] << " and " << names[i] << endl;
+                errors_exist = true;
+                continue;
+            }
+            
+            values[s.name] = s.value + moved[i][s.section];
+            defined_in[s.name] = names[i];
+        }
+    }
+}
+
+void linker::patch(int object)
+{
+    object_file* obj = objects[object];
+    
+    for (int i = 0; i < obj->fixups.size(); i++)
+    {
+        const obj_fixup &f = obj->fixups[i];
+        obj_region &r = obj->regions[f.region];
+        string name = obj->symbols[f.symbol].name;
+        int value;
+        
+        if (values.count(name) == 0)
+        {
+            cout << "Link error, " << name << " is used in " << names[object] << " but no object defines it" << endl;
+            errors_exist = true;
+            continue;
+        }
+        
+        value = values[name];
+        
+        //the instruction moved with its section, so the address after it did too
+        if (f.kind == FIXUP_DISP)
+        {
+            value -= f.next + moved[object][r.section];
+            
+            if (!bs_util::can_be_signed_one_byte_value(value))
+            {
+                cout << "Link error, " << name << " is " << value << " bytes from a relative jump in " << names[object] << ", too far" << endl;
+                errors_exist = true;
+                continue;
+            }
+        }
+        
+        r.bytes[f.offset] = bs_util::num_get_lsb(value);
+        
+        if (f.kind == FIXUP_WORD)
+            r.bytes[f.offset + 1] = bs_util::num_get_msb(value);
+    }
+}
@@ -0,0 +1,60 @@
+/*==============================================================================================
+    
+    linker.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Linker
+    10/19/26 - B.D.S.
+    Purpose: Joins objects made by siasm -c, giving their sections addresses and patching their fixups.
+    
+==============================================================================================*/
+
+#ifndef _LINKER_HPP
+#define _LINKER_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include "assembler.hpp"
+#include "object_file.hpp"
+using namespace std;
+
+class linker
+{
+    vector<object_file*> objects;
+    vector<string> names;              //file each object was read from, for errors
+    vector<vector<int> > moved;        //distance each section of each object is moved by
+    map<string, int> values;           //every exported symbol at its final address
+    map<string, string> defined_in;
+    
+    void place_sections();             //sections that are not fixed follow the same section of the objects before them
+    void collect_symbols();
+    void patch(int object);
+    
+    public:
+        bool errors_exist;
+        linker();
+        ~linker();
+        bool add(string file);         //reads an object, false if it could not be
+        bool link(assembler* out);     //puts every object's bytes in out, false if a symbol is missing or a jump is too far
+        int  symbol_count() { return values.size(); }
+};
+
+#endif
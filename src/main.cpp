@@ -20,23 +20,273 @@
     
 ==============================================================================================*/
 
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <sstream>
 #include <string>
 #include "assembler.hpp"
+#include "delta.hpp"
+#include "disassembler.hpp"
+#include "packer.hpp"
 #include "preprocessor.hpp"
+#include "stats.hpp"
+#include "tape.hpp"
+#include "watcher.hpp"
 
 using namespace std;
 
-int main(int argc, char* argv[])
+//everything given on the command line
+struct options
 {
     string tpl = "z80.tpl";
     string input_file = "testfile.bda";
+    string output_file = "";
+    string disassemble_file = "";
+    string stats_file = "";
+    string trace_file = "";
+    string map_file = "";
+    string p_file = "";
+    string wav_file = "";
+    string deps_file = "";
+    string previous_file = "";
+    string delta_file = "";
+    bool roundtrip = false;
+    bool sparse = false;
+    bool fast_load = false;
+    bool watch = false;
+    bool object = false;
+    bool stream = false;
+    bool patcher = false;
+    int pack_level = 0;
+    int threads = 0; //0 uses one for every core
+    string entry = "";
+    define_table defines;
+};
+
+//writes the image packed behind its depacker, returns false if either could not be made
+static bool export_packed(assembler* ir, string tpl, int level, string file)
+{
+    ostringstream image;
+    string raw;
+    vector<uchar> packed;
+    vector<uchar> stub;
+    ofstream outstream;
+    packer pk(level);
+    assembler* stub_as = new assembler("", tpl);
+    bool success;
+    
+    ir->write_image(image);
+    raw = image.str();
+    pk.pack((const uchar*)raw.data(), raw.length(), packed);
+    success = pk.build_stub(stub_as, ir->image_address(), stub);
+    delete stub_as;
+    
+    if (!success)
+    {
+        cout << "The depacker could not be assembled with " << tpl << endl;
+        return false;
+    }
+    
+    outstream.open(file.c_str(), ios::binary|ios::out);
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    outstream.write((const char*)&stub[0], stub.size());
+    outstream.write((const char*)&packed[0], packed.size());
+    outstream.close();
+    
+    cout << "Packed " << raw.length() << " bytes into " << packed.size() << " bytes plus a " << stub.size() << " byte depacker, ";
+    cout << "about " << pk.depack_tstates() << " T-states to unpack." << endl;
+    return true;
+}
+
+//writes the bytes that differ from an earlier image as a patch, behind a routine that applies it when patcher is set
+static bool export_delta(assembler* ir, string tpl, string previous_file, string file, bool patcher)
+{
+    ostringstream image;
+    ifstream previous(previous_file.c_str(), ios::binary|ios::in);
+    ofstream outstream;
+    vector<uchar> code;
+    
+    if (!previous.is_open())
+    {
+        cout << previous_file << " could not be opened to read!" << endl;
+        return false;
+    }
+    
+    ir->write_image(image);
+    delta dt(string(istreambuf_iterator<char>(previous), istreambuf_iterator<char>()), image.str(), ir->image_address());
+    
+    if (patcher)
+    {
+        assembler* patcher_as = new assembler("", tpl);
+        bool success = dt.build_patcher(patcher_as, code);
+        delete patcher_as;
+        
+        if (!success)
+        {
+            cout << "The patcher could not be assembled with " << tpl << endl;
+            return false;
+        }
+    }
+    
+    outstream.open(file.c_str(), ios::binary|ios::out);
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    if (code.size() > 0)
+        outstream.write((const char*)&code[0], code.size());
+    
+    dt.write(outstream);
+    outstream.close();
+    
+    cout << dt.changed_bytes() << " bytes changed since " << previous_file << ", patched with " << dt.block_count() << " blocks in ";
+    cout << dt.size() << " bytes";
+    
+    if (code.size() > 0)
+        cout << " plus a " << code.size() << " byte patcher";
+    
+    cout << "." << endl;
+    return true;
+}
+
+//writes the program as a .P file and as tape audio, named after the source file
+static bool export_tape(assembler* ir, string tpl, string input_file, string p_file, string wav_file, bool fast)
+{
+    string name = input_file.substr(input_file.find_last_of("/\\") + 1);
+    assembler* loader_as = new assembler("", tpl);
+    tape* tp = new tape(ir, loader_as, name.substr(0, name.find('.')), fast);
+    bool success = !tp->errors_exist;
+    
+    if (success && p_file != "")
+        success = tp->write_p(p_file);
+    
+    if (success && wav_file != "")
+    {
+        success = tp->write_wav(wav_file);
+        
+        if (success)
+        {
+            cout << "Wrote " << tp->seconds() << " seconds of tape";
+            
+            if (tp->fast_bytes() > 0)
+                cout << ", " << tp->fast_bytes() << " bytes of it fast loaded";
+            
+            cout << "." << endl;
+        }
+    }
+    
+    delete tp;
+    delete loader_as;
+    return success;
+}
+
+//make escapes spaces and # in file names with a backslash, and writes $ twice
+static string make_escape(string file)
+{
+    string escaped;
+    
+    for (int i = 0; i < file.length(); i++)
+    {
+        if (file[i] == ' ' || file[i] == '#')
+            escaped += '\\';
+        else if (file[i] == '$')
+            escaped += '$';
+        
+        escaped += file[i];
+    }
+    
+    return escaped;
+}
+
+//writes a make rule for target on every file that went into it, each also listed as a target with no recipe
+//so make carries on when one of them is deleted
+static bool export_dependencies(string file, string target, vector<string> sources)
+{
+    ofstream outstream;
+    outstream.open(file.c_str());
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
     
-    if (argc == 2)
-        input_file = string(argv[1]);
+    outstream << make_escape(target) << ":";
     
-    preprocessor* pr = new preprocessor(input_file);
-    pr->export_to_file(input_file + ".combined");
+    for (int i = 0; i < sources.size(); i++)
+        outstream << " \\" << endl << "  " << make_escape(sources[i]);
+    
+    outstream << endl;
+    
+    for (int i = 0; i < sources.size(); i++)
+        outstream << endl << make_escape(sources[i]) << ":" << endl;
+    
+    outstream.close();
+    return true;
+}
+
+//moves a finished file over the old one in a single step, so nothing ever sees it half written
+static bool replace_file(string from, string to)
+{
+    if (rename(from.c_str(), to.c_str()) == 0)
+        return true;
+    
+    //renaming over an existing file fails on some systems
+    remove(to.c_str());
+    
+    if (rename(from.c_str(), to.c_str()) == 0)
+        return true;
+    
+    cout << from << " could not be renamed to " << to << "!" << endl;
+    return false;
+}
+
+//preprocesses and assembles the input once, writing every output that was asked for; sources is only given
+//by --watch, which keeps files between runs and has the image replaced atomically
+static bool assemble_once(const options &opt, source_cache* sources, vector<string> &watched)
+{
+    preprocessor* pr;
+    assembler* ir = new assembler(opt.input_file+".combined", opt.tpl);
+    bool success = false;
+    
+    ir->set_threads(opt.threads);
+    ir->set_entry(opt.entry);
+    ir->set_relocatable(opt.object);
+    ir->set_streaming(opt.stream);
+    
+    //each batch of lines is assembled as soon as the preprocessor has it, so the preprocessing time includes it
+    if (opt.stream)
+    {
+        stat_timer timer(PHASE_PREPROCESS);
+        pr = new preprocessor(opt.input_file, NULL, &opt.defines, NULL,
+                              [ir](const token_ir &lines, const vector<label*> &labels, const expr_symbols &constants) {
+                                  return ir->assemble_batch(&lines, labels, constants);
+                              });
+    }
+    else
+    {
+        stat_timer timer(PHASE_PREPROCESS);
+        pr = new preprocessor(opt.input_file, sources, &opt.defines);
+        
+        //the assembler takes the tokens, the combined file is only written when --deps has no other file to name
+        if (sources == NULL && opt.deps_file != "" && opt.output_file == "" && opt.p_file == "" && opt.wav_file == "")
+            pr->export_to_file(opt.input_file + ".combined");
+    }
+    
+    watched = pr->files;
+    watched.push_back(opt.tpl);
     
     cout << "//// DISPLAYING PREPROCESSOR LABELS ////" << endl;
     
@@ -47,13 +297,223 @@ int main(int argc, char* argv[])
     
     if (!pr->errors_exist)
     {
-        assembler* ir = new assembler(input_file+".combined", tpl);
-        ir->take_label_table(&pr->labels);
-        ir->run();
-        delete ir;
+        if (!opt.stream) //streamed lines were assembled as they came
+        {
+            ir->take_label_table(&pr->labels);
+            ir->take_constants(&pr->constants);
+            ir->take_tokens(&pr->tokens);
+        }
+        
+        {
+            stat_timer timer(PHASE_ASSEMBLE);
+            
+            if (opt.stream)
+                ir->finish_batches();
+            else
+                ir->run();
+        }
+        
+        vector<string> binaries = ir->binary_files();
+        watched.insert(watched.end(), binaries.begin(), binaries.end());
+        
+        if (!ir->errors_exist)
+        {
+            stat_timer timer(PHASE_OUTPUT);
+            string image_file = (sources != NULL && opt.output_file != "") ? opt.output_file + ".tmp" : opt.output_file;
+            success = true;
+            
+            if (opt.output_file == "")
+                ir->display_results();
+            else if (opt.object)
+                success = ir->export_object(image_file);
+            else if (opt.pack_level > 0)
+                success = export_packed(ir, opt.tpl, opt.pack_level, image_file);
+            else if (opt.sparse)
+                ir->export_sparse(image_file);
+            else
+                ir->export_to_file(image_file);
+            
+            success = success && !ir->errors_exist;
+            
+            if (success && image_file != opt.output_file)
+                success = replace_file(image_file, opt.output_file);
+            
+            if (success && opt.delta_file != "")
+                success = export_delta(ir, opt.tpl, opt.previous_file, opt.delta_file, opt.patcher);
+            
+            if (opt.map_file != "")
+                success = ir->export_memory_map(opt.map_file) && success;
+            
+            if (success && (opt.p_file != "" || opt.wav_file != ""))
+                success = export_tape(ir, opt.tpl, opt.input_file, opt.p_file, opt.wav_file, opt.fast_load);
+            
+            if (success && opt.deps_file != "")
+            {
+                string target = (opt.output_file != "") ? opt.output_file : (opt.p_file != "") ? opt.p_file
+                              : (opt.wav_file != "") ? opt.wav_file : opt.input_file + ".combined";
+                
+                success = export_dependencies(opt.deps_file, target, watched);
+            }
+        }
     }
     
+    delete ir;
     pr->cleanup();
     delete pr;
-    return 0;
+    return success;
+}
+
+int main(int argc, char* argv[])
+{
+    options opt;
+    
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        
+        if (arg == "-d" && i+1 < argc)      //disassemble a binary image instead of assembling
+            opt.disassemble_file = argv[++i];
+        else if (arg == "-o" && i+1 < argc) //where to put results instead of the console
+            opt.output_file = argv[++i];
+        else if (arg == "-t" && i+1 < argc) //use a different template file
+            opt.tpl = argv[++i];
+        else if (arg == "-D" && i+1 < argc) //symbol for conditional assembly, as name or name=value
+        {
+            string define = argv[++i];
+            size_t equals = define.find('=');
+            opt.defines[define.substr(0, equals)] = (equals == string::npos) ? "1" : define.substr(equals + 1);
+        }
+        else if (arg == "-c")               //relocatable object for siasm-link instead of an image
+            opt.object = true;
+        else if (arg == "--entry" && i+1 < argc) //leave out label blocks this label never reaches
+            opt.entry = argv[++i];
+        else if (arg == "--stream")         //assemble a batch of lines at a time, keeping bytes on disk
+            opt.stream = true;
+        else if (arg == "-j" && i+1 < argc) //threads that encode instructions
+            opt.threads = atoi(argv[++i]);
+        else if (arg == "--roundtrip")      //check every template row survives assembly and disassembly
+            opt.roundtrip = true;
+        else if (arg == "--sparse")         //output holds only populated ranges, each with its address
+            opt.sparse = true;
+        else if (arg == "--map" && i+1 < argc) //memory map of every section
+            opt.map_file = argv[++i];
+        else if (arg == "--pack" && i+1 < argc) //compress output behind a depacker, level 1 is fastest and 9 packs best
+            opt.pack_level = atoi(argv[++i]);
+        else if (arg == "--delta" && i+2 < argc) //bytes that changed since an earlier image, as a patch
+        {
+            opt.previous_file = argv[++i];
+            opt.delta_file = argv[++i];
+        }
+        else if (arg == "--patcher")        //put a routine that applies the patch in front of it
+            opt.patcher = true;
+        else if (arg == "--p" && i+1 < argc) //ZX81 program file with the code in a REM
+            opt.p_file = argv[++i];
+        else if (arg == "--tape" && i+1 < argc) //the same program as tape audio
+            opt.wav_file = argv[++i];
+        else if (arg == "--fast-load")      //ranges outside the REM are loaded by a faster loader after the program
+            opt.fast_load = true;
+        else if (arg == "--deps" && i+1 < argc) //make rule listing every file the output depends on
+            opt.deps_file = argv[++i];
+        else if (arg == "--watch")          //assemble again whenever a source file changes
+            opt.watch = true;
+        else if (arg == "--stats" && i+1 < argc) //timings and counters as JSON
+            opt.stats_file = argv[++i];
+        else if (arg == "--trace" && i+1 < argc) //timings as a Chrome trace
+            opt.trace_file = argv[++i];
+        else
+            opt.input_file = arg;
+    }
+    
+    //objects are named after their source unless -o says otherwise
+    if (opt.object && opt.output_file == "")
+    {
+        size_t dot = opt.input_file.find_last_of('.');
+        size_t slash = opt.input_file.find_last_of("/\\");
+        bool extension = (dot != string::npos && (slash == string::npos || dot > slash));
+        opt.output_file = (extension ? opt.input_file.substr(0, dot) : opt.input_file) + ".obj";
+    }
+    
+    //objects are not images yet, the linker decides where their bytes go
+    if (opt.object && opt.delta_file != "")
+    {
+        cout << "--delta cannot be used with -c" << endl;
+        return 1;
+    }
+    
+    //--entry has to see every block at once, and --watch keeps every file in memory
+    if (opt.stream && (opt.entry != "" || opt.watch))
+    {
+        cout << "--stream cannot be used with " << ((opt.entry != "") ? "--entry" : "--watch") << endl;
+        return 1;
+    }
+    
+    if (opt.disassemble_file != "" || opt.roundtrip)
+    {
+        int failures = 0;
+        disassembler* dr = new disassembler(opt.tpl);
+        
+        if (opt.roundtrip && !dr->errors_exist)
+        {
+            assembler* ir = new assembler("", opt.tpl);
+            failures = dr->roundtrip(ir);
+            cout << dr->template_rows().size() << " template rows checked, " << failures << " failed." << endl;
+            delete ir;
+        }
+        
+        if (opt.disassemble_file != "" && !dr->run(opt.disassemble_file, opt.output_file))
+            failures++;
+        
+        if (dr->errors_exist)
+            failures++;
+        
+        delete dr;
+        return (failures == 0) ? 0 : 1;
+    }
+    
+    if (opt.watch)
+    {
+        source_cache sources;
+        vector<string> watched;
+        watcher wr;
+        
+        assemble_once(opt, &sources, watched);
+        
+        while (!wr.errors_exist)
+        {
+            wr.watch(watched);
+            cout << "Watching " << watched.size() << " files." << endl;
+            vector<string> changed = wr.wait();
+            long long start = stats::now_us();
+            
+            if (changed.size() == 0) //the watcher failed and has shown why
+                break;
+            
+            //only changed files are read again, everything else comes from the cache
+            for (int i = 0; i < changed.size(); i++)
+            {
+                sources.erase(changed[i]);
+                
+                if (changed[i] == opt.tpl)
+                    assembler::forget_template(opt.tpl);
+            }
+            
+            assemble_once(opt, &sources, watched);
+            cout << "Assembled again in " << (stats::now_us() - start) / 1000.0 << " ms after " << changed[0];
+            cout << ((changed.size() > 1) ? " and others" : "") << " changed." << endl;
+        }
+        
+        return 1;
+    }
+    
+    vector<string> used;
+    stats::enabled = (opt.stats_file != "" || opt.trace_file != "");
+    bool success = assemble_once(opt, NULL, used);
+    
+    if (opt.stats_file != "")
+        stats::write_json(opt.stats_file);
+    
+    if (opt.trace_file != "")
+        stats::write_trace(opt.trace_file);
+    
+    return success ? 0 : 1; //so make stops at a program that did not assemble
 }
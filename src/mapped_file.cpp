@@ -0,0 +1,118 @@
+/*==============================================================================================
+    
+    mapped_file.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "mapped_file.hpp"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_MMAP
+#endif
+
+mapped_file::mapped_file()
+{
+    bytes = NULL;
+    length = 0;
+    mapping = NULL;
+}
+
+mapped_file::~mapped_file()
+{
+    close();
+}
+
+bool mapped_file::open(string file)
+{
+    close();
+    filename = file;
+    
+#ifdef MAPPED_FILE_MMAP
+    struct stat info;
+    int fd = ::open(file.c_str(), O_RDONLY);
+    
+    if (fd < 0)
+        return false;
+    
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    
+    length = info.st_size;
+    
+    //an empty file cannot be mapped, but there is nothing to read from it either
+    if (length > 0)
+    {
+        mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        
+        if (mapping == MAP_FAILED)
+        {
+            mapping = NULL;
+            length = 0;
+            ::close(fd);
+            return false;
+        }
+        
+        bytes = (const uchar*)mapping;
+    }
+    
+    ::close(fd); //the mapping stays valid without the descriptor
+    return true;
+#else
+    ifstream stream_bin;
+    stream_bin.open(file.c_str(), ios::binary|ios::in);
+    
+    if (!stream_bin.is_open())
+        return false;
+    
+    stream_bin.seekg(0, stream_bin.end);
+    length = stream_bin.tellg();
+    stream_bin.seekg(0, stream_bin.beg);
+    buffer.resize(length);
+    
+    if (length > 0)
+    {
+        stream_bin.read((char*)&buffer[0], length);
+        bytes = &buffer[0];
+    }
+    
+    stream_bin.close();
+    return true;
+#endif
+}
+
+void mapped_file::close()
+{
+#ifdef MAPPED_FILE_MMAP
+    if (mapping != NULL)
+        munmap(mapping, length);
+#endif
+    
+    mapping = NULL;
+    bytes = NULL;
+    length = 0;
+    buffer.clear();
+}
@@ -0,0 +1,55 @@
+/*==============================================================================================
+    
+    mapped_file.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Mapped File
+    10/19/26 - B.D.S.
+    Purpose: Gives read-only access to a whole file without copying it, mapped where supported.
+    
+==============================================================================================*/
+
+#ifndef _MAPPED_FILE_HPP
+#define _MAPPED_FILE_HPP
+
+#include <string>
+#include <vector>
+#include "bs_util.hpp"
+using namespace std;
+
+class mapped_file
+{
+    string filename;
+    const uchar* bytes;  //start of the file contents, null when the file is empty
+    int length;
+    void* mapping;       //memory map of the file, null when it was read into buffer instead
+    vector<uchar> buffer;
+    
+    public:
+        mapped_file();
+        ~mapped_file();
+        bool open(string file);  //false if the file could not be opened
+        void close();
+        const uchar* data() { return bytes; }
+        int size() { return length; }
+        string name() { return filename; }
+};
+
+#endif
@@ -0,0 +1,251 @@
+/*==============================================================================================
+    
+    object_file.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "object_file.hpp"
+#include "mapped_file.hpp"
+#include <fstream>
+#include <iostream>
+
+/*  Layout, every number is two bytes with the least significant first unless it says otherwise
+
+    "siobj", then a version byte
+    section count, then for each: name length byte, name, flags byte (1 when fixed), end
+    region count, then for each: section, address, length, then that many bytes
+    symbol count, then for each: name length byte, name, section (0xFFFF for an import), value
+    fixup count, then for each: kind byte, region, offset, next, symbol
+*/
+
+static void put_word(ofstream &out, int value)
+{
+    out.put(bs_util::num_get_lsb(value));
+    out.put(bs_util::num_get_msb(value));
+}
+
+static void put_name(ofstream &out, const string &name)
+{
+    out.put(name.length());
+    out.write(name.data(), name.length());
+}
+
+//reads from a mapped file, every read past the end gives zero and sets overrun
+class object_reader
+{
+    const uchar* bytes;
+    int length;
+    int at;
+    
+    public:
+        bool overrun;
+        object_reader(const uchar* data, int size) { bytes = data; length = size; at = 0; overrun = false; }
+        int byte() { if (at < length) return bytes[at++]; overrun = true; return 0; }
+        int word() { int low = byte(); return low | (byte() << 8); }
+        
+        string name()
+        {
+            int size = byte();
+            
+            if (at + size > length)
+            {
+                overrun = true;
+                return "";
+            }
+            
+            at += size;
+            return string((const char*)bytes + at - size, size);
+        }
+        
+        const uchar* take(int size)
+        {
+            if (at + size > length)
+            {
+                overrun = true;
+                return NULL;
+            }
+            
+            at += size;
+            return bytes + at - size;
+        }
+};
+
+int object_file::add_symbol(const obj_symbol &s)
+{
+    symbols.push_back(s);
+    
+    //the first symbol of a name is the one found, as the search through the list did
+    if (symbol_ids.count(s.name) == 0)
+        symbol_ids[s.name] = symbols.size() - 1;
+    
+    return symbols.size() - 1;
+}
+
+int object_file::symbol_index(string name)
+{
+    unordered_map<string, int>::const_iterator found = symbol_ids.find(name);
+    
+    if (found != symbol_ids.end())
+        return found->second;
+    
+    obj_symbol s = { name, OBJ_IMPORT, 0 };
+    return add_symbol(s);
+}
+
+bool object_file::write(string file)
+{
+    ofstream out;
+    out.open(file.c_str(), ios::binary|ios::out);
+    
+    if (!out.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    out.write("siobj", 5);
+    out.put(OBJ_VERSION);
+    put_word(out, sections.size());
+    
+    for (int i = 0; i < sections.size(); i++)
+    {
+        put_name(out, sections[i].name);
+        out.put(sections[i].fixed ? 1 : 0);
+        put_word(out, sections[i].end);
+    }
+    
+    put_word(out, regions.size());
+    
+    for (int i = 0; i < regions.size(); i++)
+    {
+        put_word(out, regions[i].section);
+        put_word(out, regions[i].address);
+        put_word(out, regions[i].bytes.size());
+        
+        if (regions[i].bytes.size() > 0)
+            out.write((const char*)&regions[i].bytes[0], regions[i].bytes.size());
+    }
+    
+    put_word(out, symbols.size());
+    
+    for (int i = 0; i < symbols.size(); i++)
+    {
+        put_name(out, symbols[i].name);
+        put_word(out, symbols[i].section);
+        put_word(out, symbols[i].value);
+    }
+    
+    put_word(out, fixups.size());
+    
+    for (int i = 0; i < fixups.size(); i++)
+    {
+        out.put(fixups[i].kind);
+        put_word(out, fixups[i].region);
+        put_word(out, fixups[i].offset);
+        put_word(out, fixups[i].next);
+        put_word(out, fixups[i].symbol);
+    }
+    
+    out.close();
+    return true;
+}
+
+bool object_file::read(string file)
+{
+    mapped_file source;
+    
+    if (!source.open(file))
+    {
+        cout << file << " could not be opened to read!" << endl;
+        return false;
+    }
+    
+    object_reader in(source.data(), source.size());
+    const uchar* magic = in.take(5);
+    
+    if (magic == NULL || string((const char*)magic, 5) != "siobj" || in.byte() != OBJ_VERSION)
+    {
+        cout << file << " is not an object made by this version of siasm!" << endl;
+        return false;
+    }
+    
+    for (int i = 0, count = in.word(); i < count && !in.overrun; i++)
+    {
+        obj_section s;
+        s.name = in.name();
+        s.fixed = (in.byte() & 1) != 0;
+        s.end = in.word();
+        sections.push_back(s);
+    }
+    
+    for (int i = 0, count = in.word(); i < count && !in.overrun; i++)
+    {
+        obj_region r;
+        r.section = in.word();
+        r.address = in.word();
+        int length = in.word();
+        const uchar* bytes = in.take(length);
+        
+        if (bytes != NULL)
+            r.bytes.assign(bytes, bytes + length);
+        
+        regions.push_back(r);
+    }
+    
+    for (int i = 0, count = in.word(); i < count && !in.overrun; i++)
+    {
+        obj_symbol s;
+        s.name = in.name();
+        s.section = in.word();
+        s.value = in.word();
+        add_symbol(s);
+    }
+    
+    for (int i = 0, count = in.word(); i < count && !in.overrun; i++)
+    {
+        obj_fixup f;
+        f.kind = in.byte();
+        f.region = in.word();
+        f.offset = in.word();
+        f.next = in.word();
+        f.symbol = in.word();
+        fixups.push_back(f);
+    }
+    
+    //indexes are checked here so the linker can trust them
+    for (int i = 0; i < regions.size() && !in.overrun; i++)
+        in.overrun = (regions[i].section >= sections.size());
+    
+    for (int i = 0; i < symbols.size() && !in.overrun; i++)
+        in.overrun = (symbols[i].section != OBJ_IMPORT && symbols[i].section >= sections.size());
+    
+    for (int i = 0; i < fixups.size() && !in.overrun; i++)
+    {
+        in.overrun = (fixups[i].region >= regions.size() || fixups[i].symbol >= symbols.size()
+                      || fixups[i].offset + ((fixups[i].kind == FIXUP_WORD) ? 2 : 1) > regions[fixups[i].region].bytes.size());
+    }
+    
+    if (in.overrun)
+    {
+        cout << file << " is damaged!" << endl;
+        return false;
+    }
+    
+    return true;
+}
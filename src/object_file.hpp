@@ -0,0 +1,93 @@
+/*==============================================================================================
+    
+    object_file.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Object File
+    10/19/26 - B.D.S.
+    Purpose: Reads and writes relocatable objects made by siasm -c and joined by siasm-link.
+    
+==============================================================================================*/
+
+#ifndef _OBJECT_FILE_HPP
+#define _OBJECT_FILE_HPP
+
+#define OBJ_VERSION 0x1
+#define OBJ_IMPORT  0xFFFF //section of a symbol that another object defines
+#define OBJ_NAME_LIMIT 255 //names are written after a length byte
+#define OBJ_WORD_LIMIT 65535 //counts, addresses, and lengths are written in two bytes
+
+#define FIXUP_NONE  0
+#define FIXUP_WORD  1      //two bytes of the symbol's value, least significant first
+#define FIXUP_BYTE  2      //least significant byte of the symbol's value
+#define FIXUP_DISP  3      //signed distance from the address after the instruction to the symbol, for jr and djnz
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bs_util.hpp"
+using namespace std;
+
+struct obj_section
+{
+    string name;
+    bool   fixed;   //given an address by org or section, so its bytes stay where they are
+    int    end;     //address after its last byte, which is also its size when it is not fixed
+};
+
+struct obj_region
+{
+    int section;
+    int address;    //as assembled, a section that is not fixed starts at zero
+    vector<uchar> bytes;
+};
+
+struct obj_symbol
+{
+    string name;
+    int    section; //OBJ_IMPORT when it is only used here
+    int    value;
+};
+
+struct obj_fixup
+{
+    int kind;
+    int region;
+    int offset;     //index of the first byte to patch within the region
+    int next;       //address after the instruction as assembled, used by FIXUP_DISP
+    int symbol;     //index into the symbol list
+};
+
+class object_file
+{
+    unordered_map<string, int> symbol_ids; //index of every symbol in symbols by name
+    
+    public:
+        vector<obj_section> sections;
+        vector<obj_region> regions;
+        vector<obj_symbol> symbols;    //only added to with add_symbol, so symbol_index can find them
+        vector<obj_fixup> fixups;
+        int add_symbol(const obj_symbol &s); //adds a symbol, returns its index
+        int symbol_index(string name); //finds a symbol, adding it as an import if it is not there yet
+        bool write(string file);
+        bool read(string file);        //false if the file is missing or is not an object
+};
+
+#endif
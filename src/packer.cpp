@@ -0,0 +1,242 @@
+/*==============================================================================================
+    
+    packer.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "packer.hpp"
+#include <iostream>
+
+//T-states of the depacker below, used to estimate how long unpacking takes
+#define DEPACK_PROLOGUE_T 60  //everything before the loop
+#define DEPACK_LITERAL_T  66  //one trip around the loop for a literal run, not counting ldir
+#define DEPACK_MATCH_T    136 //one trip around the loop for a match, not counting ldir
+#define DEPACK_COPY_T     21  //ldir for every byte copied, it takes five fewer on the last
+#define DEPACK_END_T      31  //reading the end marker and returning
+
+//called with bc holding its own address as USR does, unpacks the data that follows it to the origin and runs it
+static const char* depacker_loop[] = {
+    "ld a,(hl)",    //control byte
+    "inc hl",
+    "cp 255",       //end of the packed data
+    "ret z",        //returns to the origin pushed by the prologue
+    "ld b,0",
+    "cp 128",
+    "jr nc,6",      //on to the match
+    "inc a",        //a literal run of control+1 bytes
+    "ld c,a",
+    "ldir",
+    "jr -17",
+    "sub 125",      //a match of control-125 bytes
+    "ld c,a",
+    "ld a,(hl)",    //distance back into the unpacked bytes, stored negative
+    "inc hl",
+    "push hl",
+    "ld h,(hl)",
+    "ld l,a",
+    "add hl,de",
+    "ldir",         //ldir copies forward a byte at a time, so matches can overlap what they copy
+    "pop hl",
+    "inc hl",
+    "jr -32"
+};
+
+packer::packer(int level)
+{
+    if (level < PACK_MIN_LEVEL)
+        level = PACK_MIN_LEVEL;
+    
+    if (level > PACK_MAX_LEVEL)
+        level = PACK_MAX_LEVEL;
+    
+    max_chain = 1 << (level + 1); //four candidates at level one up to 1024 at level nine
+    lazy = (level >= 4);
+    depack_cycles = 0;
+}
+
+static inline int hash3(const uchar* p)
+{
+    return (int)((((unsigned)p[0] << 16 | (unsigned)p[1] << 8 | p[2]) * 2654435761u) >> (32 - PACK_HASH_BITS));
+}
+
+void packer::insert(const uchar* input, int size, int pos)
+{
+    if (pos + PACK_MIN_MATCH > size)
+        return;
+    
+    int h = hash3(input + pos);
+    chain[pos & (PACK_WINDOW - 1)] = head[h];
+    head[h] = pos;
+}
+
+void packer::longest_match(const uchar* input, int size, int pos, int &length, int &distance)
+{
+    int limit = (size - pos < PACK_MAX_MATCH) ? size - pos : PACK_MAX_MATCH;
+    int candidate;
+    
+    length = 0;
+    distance = 0;
+    
+    if (limit < PACK_MIN_MATCH)
+        return;
+    
+    candidate = head[hash3(input + pos)];
+    
+    for (int tries = max_chain; candidate >= 0 && pos - candidate < PACK_WINDOW && tries > 0; tries--)
+    {
+        //checking the byte that would make a longer match first skips most candidates quickly
+        if (input[candidate + length] == input[pos + length])
+        {
+            int run = 0;
+            
+            while (run < limit && input[candidate + run] == input[pos + run])
+                run++;
+            
+            if (run > length)
+            {
+                length = run;
+                distance = pos - candidate;
+                
+                if (length == limit)
+                    break;
+            }
+        }
+        
+        int next = chain[candidate & (PACK_WINDOW - 1)];
+        
+        if (next >= candidate) //slot was reused by a position outside the window
+            break;
+        
+        candidate = next;
+    }
+    
+    if (length < PACK_MIN_MATCH)
+        length = 0;
+}
+
+void packer::flush_literals(const uchar* input, int from, int to, vector<uchar> &output)
+{
+    while (from < to)
+    {
+        int run = (to - from < PACK_MAX_LITERALS) ? to - from : PACK_MAX_LITERALS;
+        
+        output.push_back(run - 1);
+        output.insert(output.end(), input + from, input + from + run);
+        depack_cycles += DEPACK_LITERAL_T + DEPACK_COPY_T * run - 5;
+        from += run;
+    }
+}
+
+void packer::pack(const uchar* input, int size, vector<uchar> &output)
+{
+    int pos = 0;
+    int literal_start = 0; //first byte not yet written as part of a literal run or match
+    
+    head.assign(1 << PACK_HASH_BITS, -1);
+    chain.assign(PACK_WINDOW, -1);
+    output.clear();
+    output.reserve(size + size / PACK_MAX_LITERALS + 1);
+    depack_cycles = DEPACK_PROLOGUE_T + DEPACK_END_T;
+    
+    while (pos < size)
+    {
+        int length;
+        int distance;
+        
+        longest_match(input, size, pos, length, distance);
+        
+        if (length == 0)
+        {
+            insert(input, size, pos++);
+            continue;
+        }
+        
+        insert(input, size, pos);
+        
+        //a longer match one byte later is worth a literal
+        if (lazy && length < PACK_MAX_MATCH && pos + 1 < size)
+        {
+            int next_length;
+            int next_distance;
+            
+            longest_match(input, size, pos + 1, next_length, next_distance);
+            
+            if (next_length > length)
+            {
+                pos++;
+                continue;
+            }
+        }
+        
+        for (int i = 1; i < length; i++)
+            insert(input, size, pos + i);
+        
+        flush_literals(input, literal_start, pos, output);
+        output.push_back(128 + length - PACK_MIN_MATCH);
+        output.push_back(bs_util::num_get_lsb(-distance));
+        output.push_back(bs_util::num_get_msb(-distance));
+        depack_cycles += DEPACK_MATCH_T + DEPACK_COPY_T * length - 5;
+        pos += length;
+        literal_start = pos;
+    }
+    
+    flush_literals(input, literal_start, size, output);
+    output.push_back(PACK_END);
+}
+
+bool packer::build_stub(assembler* as, int origin, vector<uchar> &stub)
+{
+    vector<int> bytes;
+    vector<uchar> loop;
+    int prologue_size = 0;
+    
+    for (int i = 0; i < sizeof(depacker_loop) / sizeof(depacker_loop[0]); i++)
+    {
+        if (!as->assemble_line(depacker_loop[i], bytes))
+            return false;
+        
+        for (int j = 0; j < bytes.size(); j++)
+            loop.push_back(bytes[j]);
+    }
+    
+    //the prologue is assembled twice, once to learn its size and once with the address of the packed data
+    for (int pass = 0; pass < 2; pass++)
+    {
+        string prologue[7] = { "ld hl,", "push hl", "ld h,b", "ld l,c", "ld de,", "add hl,de", "ld de," };
+        
+        bs_util::append_int(prologue[0], origin);                      //where the depacker returns to
+        bs_util::append_int(prologue[4], prologue_size + loop.size()); //packed data starts right after the depacker
+        bs_util::append_int(prologue[6], origin);                      //where the image is unpacked to
+        stub.clear();
+        
+        for (int i = 0; i < 7; i++)
+        {
+            if (!as->assemble_line(prologue[i], bytes))
+                return false;
+            
+            for (int j = 0; j < bytes.size(); j++)
+                stub.push_back(bytes[j]);
+        }
+        
+        prologue_size = stub.size();
+    }
+    
+    stub.insert(stub.end(), loop.begin(), loop.end());
+    return true;
+}
@@ -0,0 +1,65 @@
+/*==============================================================================================
+    
+    packer.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Packer
+    10/19/26 - B.D.S.
+    Purpose: Compresses assembled images and builds the Z80 routine that unpacks them.
+    
+==============================================================================================*/
+
+#ifndef _PACKER_HPP
+#define _PACKER_HPP
+
+#define PACK_MIN_MATCH    3
+#define PACK_MAX_MATCH    129   //control bytes 128 to 254 are matches of 3 to 129 bytes
+#define PACK_MAX_LITERALS 128   //control bytes 0 to 127 are runs of 1 to 128 literal bytes
+#define PACK_END          255   //control byte that ends the packed data
+#define PACK_WINDOW       65536 //matches reach back at most 65535 bytes
+#define PACK_HASH_BITS    15
+#define PACK_MIN_LEVEL    1
+#define PACK_MAX_LEVEL    9
+
+#include <vector>
+#include "assembler.hpp"
+#include "bs_util.hpp"
+using namespace std;
+
+class packer
+{
+    int max_chain;            //candidates looked at per position, higher levels look further
+    bool lazy;                //checks whether waiting a byte finds a longer match
+    vector<int> head;         //most recent position for every hash of three bytes
+    vector<int> chain;        //previous position with the same hash, indexed by position within the window
+    long long depack_cycles;  //T-states the depacker takes for the data packed last
+    
+    void insert(const uchar* input, int size, int pos);
+    void longest_match(const uchar* input, int size, int pos, int &length, int &distance);
+    void flush_literals(const uchar* input, int from, int to, vector<uchar> &output);
+    
+    public:
+        packer(int level);
+        void pack(const uchar* input, int size, vector<uchar> &output); //replaces output with the packed data
+        bool build_stub(assembler* as, int origin, vector<uchar> &stub); //depacker for an image that runs at origin
+        long long depack_tstates() { return depack_cycles; }             //estimate for the last pack, stub included
+};
+
+#endif
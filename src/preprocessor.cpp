@@ -21,94 +21,463 @@
 ==============================================================================================*/
 
 #include "preprocessor.hpp"
+#include "lexer.hpp"
+#include "mapped_file.hpp"
+#include "snapshot.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
-preprocessor::preprocessor(string file)
+preprocessor::preprocessor(string file, source_cache* sources, const define_table* predefined, preprocessor* injected_by,
+                           line_sink stream_to)
 {
-    string line;
-    ifstream procstream;
-    procstream.open(file.c_str());
+    vector<string> source;
+    vector<string>* lines = NULL;
+    long long start = stats::enabled ? stats::now_us() : 0;
     
     errors_exist = false;
     line_num_in = 0;
     line_num_out = 1;
     filename = file;
+    cache = sources;
+    parent = injected_by;
+    sink = stream_to;
+    sink_closed = false;
+    streamed = 0;
+    active = true;
+    repeat_depth = 0;
+    repeat_count = 0;
+    files.push_back(file);
+    root()->expanded.insert(file);
+    file_token = root()->tokens.file_id(file);
     
-    if (procstream.is_open())
+    if (predefined != NULL)
+        defines = *predefined;
+    
+    if (parent == NULL)
+        snapshot::system_variables(constants);
+    
+    //only files that changed since the last run are missing from the cache, without one nothing is kept
+    if (cache == NULL)
     {
-        while (getline(procstream, line))
-        {
-            line_num_in++;
-            line = bs_util::trim(line);
-            if (filter_comments(line)) continue;
-            if (process_includes(line)) continue;
-            if (process_labels(line)) continue;
-            out = out + line + '\n';
-            line_num_out++;
-        }
+        if (!stream_source(file))
+            errors_exist = true;
     }
+    else if (cache->count(file) > 0)
+        lines = &(*cache)[file];
+    else if (!read_source(file, source))
+        errors_exist = true;
     else
+        lines = &((*cache)[file] = source);
+    
+    for (int i = 0; lines != NULL && i < lines->size(); i++)
+        process_line((*lines)[i]);
+    
+    if (conditions.size() > 0)
+        display_error(line_num_in, "#if without #endif");
+    
+    if (repeat_depth > 0)
+        display_error(line_num_in, "rept without endr");
+    
+    //the last batch goes even when it is empty, it brings the labels after the last line
+    if (parent == NULL && sink && !sink_closed)
+        pass_lines();
+    
+    stats::add_file(file, start); //includes the time of every file this one injects
+}
+
+bool preprocessor::read_source(string file, vector<string> &lines)
+{
+    mapped_file source;
+    
+    if (!source.open(file))
     {
         cout << "File(s) could not be opened to read!" << endl;
-        errors_exist = true;
+        return false;
     }
     
-    procstream.close();
+    const char* text = (const char*)source.data();
+    int length = source.size();
+    
+    //comments and spaces are left for when a line is used, lines in skipped blocks never are
+    for (int from = 0; from < length; )
+    {
+        int end = lexer::find(text, from, length, '\n', '\n');
+        lines.push_back(string(text + from, end - from));
+        from = end + 1;
+    }
+    
+    return true;
 }
 
-bool preprocessor::filter_comments(string &line)
+bool preprocessor::stream_source(string file)
 {
-    string buffer;
+    ifstream source(file.c_str(), ios::binary|ios::in);
+    vector<char> block(PREPROCESS_BLOCK);
+    string carried; //start of a line that runs on into the next block
     
-    if (line.length() > 0) //in this block we look for comments and strip them out
+    if (!source.is_open())
     {
-        if (line[0] == '/' && line[1] == '/')
-            return true;
+        cout << "File(s) could not be opened to read!" << endl;
+        return false;
+    }
+    
+    while (source.read(&block[0], block.size()) || source.gcount() > 0)
+    {
+        int length = source.gcount();
+        int from = 0;
+        
+        for (int end = lexer::find(&block[0], from, length, '\n', '\n'); end < length; end = lexer::find(&block[0], from, length, '\n', '\n'))
+        {
+            if (carried.length() > 0)
+            {
+                carried.append(&block[from], end - from);
+                process_line(carried);
+                carried.clear();
+            }
+            else
+                process_line(string(&block[from], end - from));
+            
+            from = end + 1;
+        }
+        
+        carried.append(&block[from], length - from);
+    }
+    
+    if (carried.length() > 0)
+        process_line(carried);
+    
+    return true;
+}
+
+void preprocessor::process_line(const string &text)
+{
+    line_num_in++;
+    
+    //lines in a skipped block are not lexed, only checked for a directive that could end the block
+    if (!active && repeat_depth == 0)
+    {
+        int first = lexer::skip(text.data(), 0, text.length(), ' ', '\t');
+        
+        if (first == text.length() || text[first] != '#')
+            return;
+    }
+    
+    span stripped = lexer::source_line(text.data(), 0, text.length());
+    if (stripped.length == 0) return;
+    process_stripped(text.substr(stripped.start, stripped.length));
+}
+
+void preprocessor::process_stripped(string line)
+{
+    if (process_repeats(line)) return;
+    if (!substitute(line)) return;
+    if (process_conditionals(line)) return;
+    if (process_includes(line)) return;
+    if (process_constants(line)) return;
+    if (process_labels(line)) return;
+    emit(line);
+    line_num_out++;
+}
+
+bool preprocessor::process_repeats(string &line)
+{
+    string word = line.substr(0, line.find(' '));
+    size_t comma;
+    
+    //blocks inside the one being collected are kept as they are, and expanded along with each of its lines
+    if (repeat_depth > 0)
+    {
+        if (word == "rept")
+            repeat_depth++;
+        else if (word == "endr")
+            repeat_depth--;
+        
+        if (repeat_depth > 0)
+            repeat_body.push_back(line);
+        else
+            expand_repeat();
+        
+        return true;
+    }
+    
+    if (word == "endr")
+    {
+        display_error(line_num_in, "endr without rept");
+        return true;
+    }
+    
+    if (word != "rept")
+        return false;
+    
+    //the count of a block inside another can use the outer iteration variable
+    if (!substitute(line))
+        return true;
+    
+    comma = line.find(',');
+    repeat_name = (comma == string::npos) ? "" : bs_util::trim(line.substr(comma + 1));
+    repeat_body.clear();
+    
+    if (line.length() < 6 || !condition_value(bs_util::trim(line.substr(5, comma - 5)), repeat_count) || repeat_count < 0)
+        display_error(line_num_in, "rept needs a count of zero or more, and an optional variable name");
+    else if (comma != string::npos && !bs_util::is_all_alphabetic(repeat_name))
+        display_error(line_num_in, "rept variable names are alphabetic");
+    else
+        repeat_depth = 1;
+    
+    return true;
+}
+
+void preprocessor::expand_repeat()
+{
+    vector<string> body;
+    string name = repeat_name;
+    int count = repeat_count;
+    preprocessor* top = root();
+    expr_symbols &values = top->repeat_values;
+    bool shadows = (values.count(name) > 0); //a block inside another can reuse its variable name
+    long long outer = shadows ? values[name] : 0;
+    
+    body.swap(repeat_body); //blocks inside this one collect into repeat_body again while it is expanded
+    
+    vector<int> rows(body.size(), -1); //line of the tokens each body line went out as, while it is the same every time
+    
+    for (int i = 0; i < count && !errors_exist; i++)
+    {
+        if (name != "")
+            values[name] = i;
         
-        for (int i = 0; i < line.length()-1; i++) //get everything upto potential comments
+        for (int j = 0; j < body.size(); j++)
         {
-            if (line[i] == '/' && line[i+1] == '/')
-                break;
+            int before = top->tokens.size();
+            
+            //a line with nothing to substitute that went out as it was goes out the same way again, as tokens
+            if (rows[j] >= 0 && active && repeat_depth == 0)
+            {
+                top->tokens.copy_line(rows[j]);
+                line_num_out++;
+                continue;
+            }
+            
+            process_stripped(body[j]);
             
-            buffer += line[i];
+            //directives are left out, a one line file injected with #once goes out only the first time
+            if (!top->sink && body[j][0] != '#' && body[j].find('{') == string::npos && top->tokens.size() == before + 1)
+                rows[j] = before;
+        }
+    }
+    
+    if (shadows)
+        values[name] = outer;
+    else
+        values.erase(name);
+}
+
+bool preprocessor::substitute(string &line)
+{
+    const expr_symbols &values = root()->repeat_values;
+    size_t open = line.find('{');
+    size_t from = 0;
+    string result;
+    
+    if (open == string::npos || values.size() == 0)
+        return true;
+    
+    for ( ; open != string::npos; open = line.find('{', from))
+    {
+        size_t close = line.find('}', open);
+        expression formula;
+        expr_value value;
+        string err_msg;
+        
+        if (close == string::npos)
+            err_msg = "{ without }";
+        else if (formula.parse(line.substr(open + 1, close - open - 1), err_msg) && formula.evaluate(values, value, err_msg)
+                 && (expression::scaled(value, 0) < INT_MIN || expression::scaled(value, 0) > INT_MAX))
+            err_msg = "{" + line.substr(open + 1, close - open - 1) + "} is out of range";
+        
+        if (err_msg != "")
+        {
+            display_error(line_num_in, err_msg);
+            return false;
+        }
+        
+        result.append(line, from, open - from);
+        bs_util::append_int(result, (int)expression::scaled(value, 0));
+        from = close + 1;
+    }
+    
+    result.append(line, from, string::npos);
+    line = result;
+    return true;
+}
+
+void preprocessor::emit(const string &line)
+{
+    preprocessor* top = root();
+    
+    if (top->sink_closed) //the rest of the program is still read for errors, but nothing takes its lines
+        return;
+    
+    //lines are only lexed, the assembler takes them as they are, a batch at a time when streaming
+    top->tokens.add_line(line.data(), line.length(), file_token, line_num_in);
+    
+    if (top->sink && top->tokens.size() >= STREAM_LINES)
+        top->pass_lines();
+}
+
+void preprocessor::pass_lines()
+{
+    sink_closed = !sink(tokens, labels, constants);
+    streamed += tokens.size();
+    tokens.clear(); //names keep their ids, the assembler still spells symbols with them
+}
 
-            //add last character that is otherwise skipped
-            if (i == line.length()-2)
-                buffer += line[i+1]; 
+bool preprocessor::process_conditionals(string &line)
+{
+    istringstream words(line);
+    string directive;
+    string name;
+    string extra;
+    define_table &symbols = root()->defines;
+    
+    words >> directive;
+    
+    if (directive == "#if" || directive == "#ifdef" || directive == "#ifndef")
+    {
+        condition c = { active, false, false };
+        vector<string> operands;
+        
+        while (words >> name)
+            operands.push_back(name);
+        
+        if (active && directive != "#if")
+        {
+            if (operands.size() != 1)
+                display_error(line_num_in, directive + " needs one symbol");
+            else
+                c.taken = ((symbols.count(operands[0]) > 0) == (directive == "#ifdef"));
+        }
+        else if (active)
+        {
+            int left = 0;
+            int right = 0;
+            string op = (operands.size() == 3) ? operands[1] : "";
+            
+            if (operands.size() == 1 && condition_value(operands[0], left))
+                c.taken = (left != 0);
+            else if (operands.size() == 3 && condition_value(operands[0], left) && condition_value(operands[2], right)
+                     && (op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" || op == ">="))
+            {
+                c.taken = (op == "==") ? left == right : (op == "!=") ? left != right : (op == "<") ? left < right
+                        : (op == ">") ? left > right : (op == "<=") ? left <= right : left >= right;
+            }
+            else
+                display_error(line_num_in, "#if needs a value, or two values compared with ==, !=, <, >, <=, or >=");
+        }
+        
+        conditions.push_back(c);
+        active = c.outer_active && c.taken;
+        return true;
+    }
+    
+    if (directive == "#else" || directive == "#endif")
+    {
+        if (conditions.size() == 0)
+            display_error(line_num_in, directive + " without #if");
+        else if (directive == "#else" && conditions.back().in_else)
+            display_error(line_num_in, "#else after #else");
+        else if (directive == "#else")
+        {
+            conditions.back().in_else = true;
+            active = conditions.back().outer_active && !conditions.back().taken;
+        }
+        else
+        {
+            active = conditions.back().outer_active;
+            conditions.pop_back();
         }
         
-        line = bs_util::trim_right(buffer);
+        return true;
     }
+    
+    if (!active) //anything else in a skipped block is ignored, even a malformed directive
+        return true;
+    
+    if (directive == "#define")
+    {
+        if (!(words >> name) || !bs_util::is_all_alphabetic(name))
+            display_error(line_num_in, "#define needs an alphabetic symbol name");
+        else if (!(words >> extra))
+            symbols[name] = "1";
+        else
+            symbols[name] = extra;
+        
+        return true;
+    }
+    
+    return false;
+}
 
-    //true indicates the input line is a comment and should be skipped, false otherwise
-    return (line.length() == 0);
+bool preprocessor::condition_value(string operand, int &value)
+{
+    define_table &symbols = root()->defines;
+    
+    if (symbols.count(operand) > 0)
+        operand = symbols[operand];
+    else if (operand.length() > 0 && bs_util::is_all_alphabetic(operand))
+        operand = "0"; //symbols that were never defined count as zero
+    
+    if (!bs_util::is_all_numeric(operand))
+        return false;
+    
+    value = atoi(operand.c_str());
+    return true;
 }
 
 bool preprocessor::process_includes(string &line)
 {
 	string path;
+    bool once;
     
     if (line[0] != '#')
         return false;
     
-    if (line.length() < 11 || line.substr(0,9) != "#inject <" || line[line.length()-1] != '>')
+    if (line == "#once") //later injects of this file are skipped
+    {
+        root()->guarded.insert(filename);
+        return true;
+    }
+    
+    once = (line.substr(0,14) == "#inject_once <");
+    
+    if ((once && line.length() < 16) || (!once && (line.length() < 11 || line.substr(0,9) != "#inject <")) || line[line.length()-1] != '>')
     {
         display_error(line_num_in, "unknown or malformed preprocessor command");
         return false;
     }
     
     //unwrap the candy bar
-    path = bs_util::remove_outer_chars(line.substr(8,string::npos)); 
+    path = bs_util::remove_outer_chars(line.substr(once ? 13 : 8, string::npos)); 
+    
+    //guarded files were already expanded, so they are skipped without being read again
+    if (root()->guarded.count(path) > 0 || (once && root()->expanded.count(path) > 0))
+        return true;
     
-    if (path == filename)
+    for (preprocessor* p = this; p != NULL; p = p->parent)
     {
-        display_error(line_num_in, "included file cannot be source file");
-        return false;
+        if (p->filename == path)
+        {
+            display_error(line_num_in, "inject cycle, " + inject_chain(path));
+            return true;
+        }
     }
     
-    preprocessor* pr = new preprocessor(path);
-    out += pr->export_to_str(); //append included file to ours
+    preprocessor* pr = new preprocessor(path, cache, NULL, this); //its lines are added to ours as it goes
     
     //since we're injecting, we need to adjust line numbers of upstream labels
     //to reflect the values of our current file
@@ -120,6 +489,13 @@ bool preprocessor::process_includes(string &line)
     
     line_num_out += pr->line_num_out - 1; //take child's line out count and append
     
+    //files injected more than once only need listing once
+    for (int i = 0; i < pr->files.size(); i++)
+    {
+        if (find(files.begin(), files.end(), pr->files[i]) == files.end())
+            files.push_back(pr->files[i]);
+    }
+    
     //create space and add included labels
     labels.reserve(labels.size() + pr->labels.size());
     labels.insert(labels.end(), pr->labels.begin(), pr->labels.end());
@@ -141,29 +517,78 @@ bool preprocessor::process_labels(string &line)
     {
         label_name = line.substr(1,string::npos);
         
-        for (int i = 0; i < labels.size(); i++) //check to see our new found line isn't already defined
-        {
-            if (labels[i]->name == label_name)
-                display_error(line_num_out, "duplicate labels, " + label_name + " is already in use.");
-        }
+        //labels and constants share one set of names across every file
+        if (root()->label_names.count(label_name) > 0 || root()->constants.count(label_name) > 0)
+            display_error(line_num_in, "duplicate labels, " + label_name + " is already in use.");
         
-        if (bs_util::is_all_alphabetic(label_name)) //add our label to the list if it is properly defined
+        if (bs_util::is_name(label_name)) //add our label to the list if it is properly defined
         {
+            preprocessor* top = root();
+            
             l = new label();
             l->name = label_name;
             l->line = line_num_out;
-            labels.push_back(l);
+            
+            //streamed labels go straight to the source file, numbered across the whole program, so the
+            //assembler has them before the file they are in is finished
+            if (top->sink)
+            {
+                l->line = top->streamed + top->tokens.size() + 1;
+                top->labels.push_back(l);
+            }
+            else
+                labels.push_back(l);
+            
+            top->label_names.insert(label_name);
             return true;
         }
-        else display_error(line_num_out, "incorrect label format");
+        else display_error(line_num_in, "incorrect label format");
     }
     
     return false;
 }
 
+bool preprocessor::process_constants(string &line)
+{
+    size_t space = line.find(' ');
+    size_t word = (space == string::npos) ? string::npos : line.find_first_not_of(' ', space);
+    expr_symbols &known = root()->constants;
+    expression formula;
+    expr_value result;
+    string err_msg;
+    
+    if (word == string::npos || line.compare(word, 3, "equ") != 0 || (word + 3 < line.length() && line[word+3] != ' '))
+        return false;
+    
+    string name = line.substr(0, space);
+    
+    //constants only see the ones defined before them, so there is never a loop to find
+    if (!bs_util::is_name(name))
+        display_error(line_num_in, "incorrect constant name " + name);
+    else if (known.count(name) > 0 || root()->label_names.count(name) > 0)
+        display_error(line_num_in, "duplicate names, " + name + " is already in use.");
+    else if (!formula.parse(bs_util::trim(line.substr(word + 3)), err_msg) || !formula.evaluate(known, result, err_msg))
+        display_error(line_num_in, err_msg + " in constant " + name);
+    else if (expression::scaled(result, 0) < -32768 || expression::scaled(result, 0) > 65535)
+        display_error(line_num_in, "constant " + name + " does not fit in 16 bits");
+    else
+        known[name] = expression::scaled(result, 0);
+    
+    return true;
+}
+
 string preprocessor::export_to_str()
 {
-    return out;
+    string text;
+    
+    //spelled back from the tokens, which is only done when the text is asked for
+    for (int i = 0; i < tokens.size(); i++)
+    {
+        text += tokens.spell_line(i);
+        text += '\n';
+    }
+    
+    return text;
 }
 
 void preprocessor::export_to_file(string file)
@@ -172,11 +597,31 @@ void preprocessor::export_to_file(string file)
     outstream.open(file.c_str());
     
     if (outstream.is_open())
-        outstream << out << endl;
+        outstream << export_to_str() << endl;
     
     outstream.close();
 }
 
+preprocessor* preprocessor::root()
+{
+    preprocessor* p = this;
+    
+    while (p->parent != NULL)
+        p = p->parent;
+    
+    return p;
+}
+
+string preprocessor::inject_chain(string path)
+{
+    string chain = path;
+    
+    for (preprocessor* p = this; p != NULL; p = p->parent)
+        chain = p->filename + " -> " + chain;
+    
+    return chain;
+}
+
 void preprocessor::display_error(int line_num, string err_msg)
 {
     cout << "Preprocess error, in " << filename;
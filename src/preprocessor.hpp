@@ -29,29 +29,88 @@
 #ifndef _PREPROCESSOR_HPP
 #define _PREPROCESSOR_HPP
 
+#define PREPROCESS_BLOCK 1048576 //bytes read from a file at a time when streaming
+#define STREAM_LINES     65536   //lines handed to the assembler at a time when streaming
+
 #include "bs_util.hpp"
+#include "expression.hpp"
+#include "token_ir.hpp"
+#include <functional>
+#include <map>
+#include <set>
 #include <vector>
 
 using namespace std;
 
+//lines of each file as they were read, kept between runs by --watch
+typedef map<string, vector<string> > source_cache;
+
+//symbols for conditional assembly and their values
+typedef map<string, string> define_table;
+
+//takes a batch of streamed lines along with every label and constant found so far, false stops any more coming
+typedef function<bool(const token_ir &lines, const vector<label*> &labels, const expr_symbols &constants)> line_sink;
+
+//an #if, #ifdef, or #ifndef that has not reached its #endif
+struct condition
+{
+    bool outer_active; //lines around the block are assembled
+    bool taken;        //the #if branch was taken, so the #else branch is not
+    bool in_else;
+};
+
 class preprocessor
 {
-    string out;
+    line_sink sink;                                   //kept by the source file, where lines are streamed, empty to keep them all
+    bool sink_closed;                                 //kept by the source file, the sink stopped taking lines
+    int streamed;                                     //kept by the source file, lines already handed to the sink
     string filename;
+    int file_token;                                   //id of filename in the tokens of the source file
     int line_num_in;                                  //the line number of the file we are reading in
     int line_num_out;                                 //the line number of the file we are writing out
+    source_cache* cache;                              //where files are looked for before reading them, may be null
+    preprocessor* parent;                             //file that injected this one, null for the source file
+    set<string> guarded;                              //kept by the source file, files marked #once
+    set<string> expanded;                             //kept by the source file, every file injected so far
+    define_table defines;                             //kept by the source file, symbols from -D and #define
+    vector<condition> conditions;                     //blocks open in this file, innermost last
+    bool active;                                      //false while inside a block that is skipped
+    int repeat_depth;                                 //rept lines without their endr while a block is collected
+    int repeat_count;                                 //times the block being collected is assembled
+    string repeat_name;                               //its iteration variable, empty when it has none
+    vector<string> repeat_body;                       //lines of the block, stripped but otherwise untouched
+    expr_symbols repeat_values;                       //kept by the source file, iteration variables of blocks being expanded
+    set<string> label_names;                          //kept by the source file, every label of every file so far, to find repeats
+    
+    preprocessor* root();                             //the source file at the top of the inject chain
+    string inject_chain(string path);                 //the files from the source file down to this one, then path
     
-    bool filter_comments(string &line);               //removes comments from each line in the instructions
+    bool read_source(string file, vector<string> &lines); //reads a file a line at a time, comments removed
+    bool stream_source(string file);                  //processes a file a block at a time without keeping its lines
+    void process_line(const string &text);            //strips a line and handles it, or passes it on to the assembler
+    void process_stripped(string line);               //handles a stripped line, from the file or from a rept block
+    bool process_repeats(string &line);               //rept and endr, and lines of a block being collected, true if the line is used up
+    void expand_repeat();                             //handles every line of the collected block once for each iteration
+    bool substitute(string &line);                    //replaces each {expression} with its value for the current iterations
+    void emit(const string &line);                    //adds a line to the output of the source file
+    void pass_lines();                                //hands the lines held so far to the sink and drops them
+    bool process_conditionals(string &line);          //#define, #if, #ifdef, #ifndef, #else, and #endif, true if the line is used up
+    bool condition_value(string operand, int &value); //a number, or the value of a symbol, zero when it is not defined
     bool process_includes(string &line);              //checks lines for #include<file> and processes what it finds
     bool process_labels(string &line);                //checks lines for .labels, checks for repeats, and adds them to a list
+    bool process_constants(string &line);             //name equ expression, true if the line is used up
     void display_error(int line_num, string err_msg); //to be called when an irrecoverrable error occurs.
     
     public:
         bool errors_exist;                            //funneled down between included documents to determine successful preprocessing
         vector<label*> labels;                        //list of label structures that we can pass to the assembler
+        vector<string> files;                         //this file and every file injected into it, directly or not
+        token_ir tokens;                              //every line passed on to the assembler, lexed, only a batch of them when streaming
+        expr_symbols constants;                       //kept by the source file, the system variables and every equ constant
         string export_to_str();                       //export instructions to be included in other documents
         void export_to_file(string file);             //export instructions for the assembler to handle
-        preprocessor(string file);
+        preprocessor(string file, source_cache* sources = NULL, const define_table* predefined = NULL, preprocessor* injected_by = NULL,
+                     line_sink stream_to = line_sink());
         void cleanup();                               //delete all the labels we created earlier
 };
 
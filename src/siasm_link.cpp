@@ -0,0 +1,98 @@
+/*==============================================================================================
+    
+    siasm_link.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Link Program
+    10/19/26 - B.D.S.
+    Purpose: Command line for joining objects made by siasm -c into one image.
+    
+==============================================================================================*/
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "assembler.hpp"
+#include "linker.hpp"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    string output_file = "";
+    string map_file = "";
+    bool sparse = false;
+    vector<string> object_files;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        
+        if (arg == "-o" && i+1 < argc)      //where the image goes
+            output_file = argv[++i];
+        else if (arg == "--sparse")         //image holds only populated ranges, as with siasm
+            sparse = true;
+        else if (arg == "--map" && i+1 < argc) //memory map of every section
+            map_file = argv[++i];
+        else
+            object_files.push_back(arg);
+    }
+    
+    if (output_file == "" || object_files.size() == 0)
+    {
+        cout << "siasm-link [--sparse] [--map file] -o file object..." << endl;
+        return 1;
+    }
+    
+    linker* lk = new linker();
+    assembler* image = new assembler("", ""); //only used to place and write bytes, so it needs no template
+    bool success = true;
+    
+    for (int i = 0; i < object_files.size(); i++)
+        success = lk->add(object_files[i]) && success;
+    
+    success = success && lk->link(image);
+    
+    if (success)
+    {
+        if (sparse)
+            image->export_sparse(output_file);
+        else
+            image->export_to_file(output_file);
+        
+        success = !image->errors_exist;
+        
+        if (map_file != "")
+            success = image->export_memory_map(map_file) && success;
+    }
+    
+    if (success)
+    {
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "Linked " << object_files.size() << " object(s), " << lk->symbol_count() << " symbol(s), and ";
+        cout << image->output_size() << " byte(s) in " << ms << " ms." << endl;
+    }
+    
+    delete image;
+    delete lk;
+    return success ? 0 : 1;
+}
@@ -22,8 +22,26 @@
 
 #include "snapshot.hpp"
 
-snapshot::snapshot(int prog_size)
+//the names the ZX81 manual gives the system variables, spelled the same as their offsets above
+#define SYSTEM_VARIABLE(name) { #name, SYS_BASE + name }
+
+static const struct { const char* name; int address; } system_variable_table[] = {
+    SYSTEM_VARIABLE(ERR_NR), SYSTEM_VARIABLE(FLAGS),  SYSTEM_VARIABLE(ERR_SP), SYSTEM_VARIABLE(RAMTOP),
+    SYSTEM_VARIABLE(MODE),   SYSTEM_VARIABLE(PPC),    SYSTEM_VARIABLE(VERSN),  SYSTEM_VARIABLE(E_PPC),
+    SYSTEM_VARIABLE(D_FILE), SYSTEM_VARIABLE(DF_CC),  SYSTEM_VARIABLE(VARS),   SYSTEM_VARIABLE(DEST),
+    SYSTEM_VARIABLE(E_LINE), SYSTEM_VARIABLE(CH_ADD), SYSTEM_VARIABLE(X_PTR),  SYSTEM_VARIABLE(STKBOT),
+    SYSTEM_VARIABLE(STKEND), SYSTEM_VARIABLE(BREG),   SYSTEM_VARIABLE(MEM),    SYSTEM_VARIABLE(DF_SZ),
+    SYSTEM_VARIABLE(S_TOP),  SYSTEM_VARIABLE(LAST_K), SYSTEM_VARIABLE(LK_DB),  SYSTEM_VARIABLE(MARGIN),
+    SYSTEM_VARIABLE(NXTLIN), SYSTEM_VARIABLE(OLDPPC), SYSTEM_VARIABLE(FLAGX),  SYSTEM_VARIABLE(STRLEN),
+    SYSTEM_VARIABLE(T_ADDR), SYSTEM_VARIABLE(SEED),   SYSTEM_VARIABLE(FRAMES), SYSTEM_VARIABLE(COORDS),
+    SYSTEM_VARIABLE(PR_CC),  SYSTEM_VARIABLE(S_POSN), SYSTEM_VARIABLE(CDFLAG), SYSTEM_VARIABLE(PRBUFF),
+    SYSTEM_VARIABLE(MEMBOT)
+};
+
+snapshot::snapshot()
 {
+    run_line = 0;
+    
     sys_val[ERR_NR] = 0xFF;
     sys_val[FLAGS] =  0x01;
     sys_val[ERR_SP] = 0xFC; sys_val[ERR_SP+1] = 0x47;
@@ -42,7 +60,8 @@ snapshot::snapshot(int prog_size)
     sys_val[STKBOT] = 0x9A; sys_val[STKBOT+1] = 0x40;
     sys_val[STKEND] = 0x9A; sys_val[STKEND+1] = 0x40;
     sys_val[BREG] =   0xFF;
-    sys_val[MEM] =    0x00; sys_val[MEM+1] =    0x00;
+    sys_val[MEM] =    0x5D; sys_val[MEM+1] =    0x40;
+    sys_val[MEM+2] =  0x00; //16417 is unused, but it is saved in a .P like the rest
     sys_val[DF_SZ] =  0x02;
     sys_val[S_TOP] =  0x00; sys_val[S_TOP+1] =  0x00;
     sys_val[LAST_K] = 0xFF; sys_val[LAST_K+1] = 0xFF;
@@ -64,4 +83,112 @@ snapshot::snapshot(int prog_size)
     {
         sys_val[PRBUFF+i] = 0x00;
     }
+    
+    sys_val[PRBUFF+32] = ZX_NEWLINE;
+    
+    for (int i = MEMBOT; i < PROGRAM_START - SYS_BASE; i++)
+        sys_val[i] = 0x00;
+}
+
+void snapshot::set_word(int var, int value)
+{
+    sys_val[var] = bs_util::num_get_lsb(value);
+    sys_val[var+1] = bs_util::num_get_msb(value);
+}
+
+int snapshot::add_line(int number, const vector<uchar> &text)
+{
+    int address = PROGRAM_START + program.size() + 4;
+    
+    //line numbers are most significant byte first, lengths least significant first and count the newline
+    program.push_back(number >> 8);
+    program.push_back(number & 0xFF);
+    program.push_back(bs_util::num_get_lsb(text.size() + 1));
+    program.push_back(bs_util::num_get_msb(text.size() + 1));
+    program.insert(program.end(), text.begin(), text.end());
+    program.push_back(ZX_NEWLINE);
+    return address;
+}
+
+int snapshot::end_address()
+{
+    return PROGRAM_START + program.size() + DISPLAY_SIZE + 1; //the variables area is just its end marker
+}
+
+void snapshot::write_p(ostream &out)
+{
+    int d_file = PROGRAM_START + program.size();
+    int vars = d_file + DISPLAY_SIZE;
+    int e_line = vars + 1;
+    
+    set_word(D_FILE, d_file);
+    set_word(DF_CC, d_file + 1);
+    set_word(VARS, vars);
+    set_word(E_LINE, e_line);
+    set_word(CH_ADD, e_line + 2);
+    set_word(STKBOT, e_line + 2);
+    set_word(STKEND, e_line + 2);
+    set_word(NXTLIN, (run_line != 0) ? run_line - 4 : d_file); //pointing at the display file runs nothing
+    
+    out.write((const char*)sys_val + (P_FILE_START - SYS_BASE), PROGRAM_START - P_FILE_START);
+    
+    if (program.size() > 0)
+        out.write((const char*)&program[0], program.size());
+    
+    out.put((char)ZX_NEWLINE);
+    
+    for (int row = 0; row < 24; row++)
+    {
+        out << string(32, '\0');
+        out.put((char)ZX_NEWLINE);
+    }
+    
+    out.put((char)0x80); //end of the variables
+}
+
+void snapshot::append_number(vector<uchar> &text, int value)
+{
+    string digits;
+    int exponent = 0;
+    unsigned int mantissa = value;
+    
+    bs_util::append_int(digits, value);
+    
+    for (int i = 0; i < digits.length(); i++)
+        text.push_back(character(digits[i]));
+    
+    text.push_back(ZX_NUMBER);
+    
+    //five byte floating point, an exponent biased by 128 then a mantissa whose top bit is replaced by the sign
+    while (mantissa != 0 && (mantissa & 0x80000000) == 0)
+    {
+        mantissa <<= 1;
+        exponent++;
+    }
+    
+    text.push_back((mantissa == 0) ? 0 : 0x80 + 32 - exponent);
+    text.push_back((mantissa >> 24) & 0x7F);
+    text.push_back((mantissa >> 16) & 0xFF);
+    text.push_back((mantissa >> 8) & 0xFF);
+    text.push_back(mantissa & 0xFF);
+}
+
+uchar snapshot::character(char c)
+{
+    if (c >= '0' && c <= '9')
+        return 0x1C + (c - '0');
+    
+    if (c >= 'A' && c <= 'Z')
+        return 0x26 + (c - 'A');
+    
+    if (c >= 'a' && c <= 'z')
+        return 0x26 + (c - 'a');
+    
+    return 0x00; //space
+}
+
+void snapshot::system_variables(expr_symbols &symbols)
+{
+    for (int i = 0; i < sizeof(system_variable_table) / sizeof(system_variable_table[0]); i++)
+        symbols[system_variable_table[i].name] = system_variable_table[i].address;
 }
@@ -29,8 +29,6 @@
 #ifndef _SNAPSHOT_HPP
 #define _SNAPSHOT_HPP
 
-#include "bs_util.hpp"
-
 #define ERR_NR 0x00
 #define FLAGS  0x01
 #define ERR_SP 0x02
@@ -69,10 +67,42 @@
 #define PRBUFF 0x3C
 #define MEMBOT 0x5D
 
+#define SYS_BASE      0x4000 //address of ERR_NR, system variables are offsets from here
+#define P_FILE_START  0x4009 //.P files and tapes hold memory from VERSN up to E_LINE
+#define PROGRAM_START 0x407D //first BASIC line, right after the system variables
+#define REM_ADDRESS   16514  //text of a REM on the first line, the usual home of machine code
+#define DISPLAY_SIZE  793    //expanded display file, a newline then 24 rows of 32 spaces and a newline
+
+#define ZX_NEWLINE 0x76
+#define ZX_NUMBER  0x7E //follows the digits of a number in a BASIC line, then five bytes of floating point
+#define ZX_USR     0xD4
+#define ZX_REM     0xEA
+#define ZX_RAND    0xF9
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "bs_util.hpp"
+#include "expression.hpp"
+using namespace std;
+
 class snapshot
 {
-    snapshot(int prog_size);
     uchar sys_val[2048];
+    vector<uchar> program; //BASIC lines in their tokenized form
+    int run_line;          //address of the text of the line to run once loaded, zero for none
+    
+    void set_word(int var, int value);
+    
+    public:
+        snapshot();
+        int  add_line(int number, const vector<uchar> &text); //appends a line and returns the address of its text
+        void auto_run(int address) { run_line = address; }   //runs the line add_line gave this address for after loading
+        int  end_address();                                   //E_LINE, one past the last byte of the .P file
+        void write_p(ostream &out);                           //system variables, program, display, and variables
+        static void append_number(vector<uchar> &text, int value); //number as it appears in a BASIC line
+        static uchar character(char c);                       //ZX81 character code for a letter, digit, or space
+        static void system_variables(expr_symbols &symbols);  //adds the address of every system variable by its name
 };
 
 #endif
@@ -0,0 +1,175 @@
+/*==============================================================================================
+    
+    stats.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "stats.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+struct trace_event
+{
+    string    name;
+    string    category;
+    long long start;    //microseconds
+    long long duration;
+};
+
+static const char* counter_names[STAT_COUNT] = {
+    "lines", "files", "template_scans", "resolve_calls", "resolve_retries", "exceptions", "bytes_emitted",
+    "cache_lookups", "cache_hits"
+};
+
+static const char* phase_names[PHASE_COUNT] = {
+    "preprocess", "assemble", "lookup", "output", "encode"
+};
+
+static atomic<long long> phase_totals[PHASE_COUNT]; //lookups are timed on every thread that encodes
+static vector<trace_event> events;    //every timed phase and file in the order they finished
+static vector<trace_event> file_times;
+
+bool stats::enabled = false;
+atomic<long long> stats::counters[STAT_COUNT];
+
+static string json_escape(string input)
+{
+    string output;
+    
+    for (int i = 0; i < input.length(); i++)
+    {
+        if (input[i] == '"' || input[i] == '\\')
+            output += '\\';
+        
+        output += input[i];
+    }
+    
+    return output;
+}
+
+long long stats::now_us()
+{
+    static const chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - origin).count();
+}
+
+void stats::add_phase(int phase, long long start_us)
+{
+    long long duration = now_us() - start_us;
+    phase_totals[phase] += duration;
+    
+    //lookups happen several times an instruction, only their total is worth keeping
+    if (phase != PHASE_LOOKUP)
+    {
+        trace_event ev = { phase_names[phase], "phase", start_us, duration };
+        events.push_back(ev);
+    }
+}
+
+void stats::add_file(string file, long long start_us)
+{
+    if (!enabled)
+        return;
+    
+    trace_event ev = { file, "file", start_us, now_us() - start_us };
+    counters[STAT_FILES]++;
+    events.push_back(ev);
+    file_times.push_back(ev);
+}
+
+double stats::seconds(int phase)
+{
+    return phase_totals[phase] / 1e6;
+}
+
+bool stats::write_json(string file)
+{
+    ofstream outstream;
+    long long lines = counters[STAT_LINES];
+    long long resolves = counters[STAT_RESOLVE_CALLS];
+    long long lookups = counters[STAT_CACHE_LOOKUPS];
+    
+    outstream.open(file.c_str());
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    outstream << "{" << endl << "  \"seconds\": {";
+    
+    for (int i = 0; i < PHASE_COUNT; i++)
+        outstream << ((i > 0) ? ", " : "") << "\"" << phase_names[i] << "\": " << seconds(i);
+    
+    outstream << "}," << endl;
+    outstream << "  \"counters\": {";
+    
+    for (int i = 0; i < STAT_COUNT; i++)
+        outstream << ((i > 0) ? ", " : "") << "\"" << counter_names[i] << "\": " << counters[i];
+    
+    outstream << "}," << endl;
+    outstream << "  \"template_scans_per_line\": " << ((lines > 0) ? (double)counters[STAT_TEMPLATE_SCANS] / lines : 0) << "," << endl;
+    outstream << "  \"retries_per_resolve\": " << ((resolves > 0) ? (double)counters[STAT_RESOLVE_RETRIES] / resolves : 0) << "," << endl;
+    outstream << "  \"cache_hit_rate\": " << ((lookups > 0) ? (double)counters[STAT_CACHE_HITS] / lookups : 0) << "," << endl;
+    outstream << "  \"files\": [";
+    
+    for (int i = 0; i < file_times.size(); i++)
+    {
+        outstream << ((i > 0) ? "," : "") << endl;
+        outstream << "    {\"file\": \"" << json_escape(file_times[i].name) << "\", \"seconds\": " << file_times[i].duration / 1e6 << "}";
+    }
+    
+    outstream << endl << "  ]" << endl << "}" << endl;
+    outstream.close();
+    return true;
+}
+
+bool stats::write_trace(string file)
+{
+    ofstream outstream;
+    outstream.open(file.c_str());
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    outstream << "{\"traceEvents\": [";
+    
+    for (int i = 0; i < events.size(); i++)
+    {
+        outstream << ((i > 0) ? "," : "") << endl;
+        outstream << "  {\"name\": \"" << json_escape(events[i].name) << "\", \"cat\": \"" << events[i].category
+                  << "\", \"ph\": \"X\", \"ts\": " << events[i].start << ", \"dur\": " << events[i].duration
+                  << ", \"pid\": 1, \"tid\": 1}";
+    }
+    
+    //counters go in as a single sample at the end so they show up alongside the timeline
+    outstream << ((events.size() > 0) ? "," : "") << endl << "  {\"name\": \"counters\", \"ph\": \"C\", \"ts\": " << now_us() << ", \"pid\": 1, \"args\": {";
+    
+    for (int i = 0; i < STAT_COUNT; i++)
+        outstream << ((i > 0) ? ", " : "") << "\"" << counter_names[i] << "\": " << counters[i];
+    
+    outstream << "}}" << endl << "]}" << endl;
+    outstream.close();
+    return true;
+}
@@ -0,0 +1,80 @@
+/*==============================================================================================
+    
+    stats.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Statistics
+    10/19/26 - B.D.S.
+    Purpose: Collects phase timings and counters, costs one branch per call when disabled.
+    
+==============================================================================================*/
+
+#ifndef _STATS_HPP
+#define _STATS_HPP
+
+#define STAT_LINES           0 //instruction lines handed to the assembler
+#define STAT_FILES           1 //files read by the preprocessor, including injected ones
+#define STAT_TEMPLATE_SCANS  2 //calls to scan_template_file
+#define STAT_RESOLVE_CALLS   3 //calls to resolve_instruction
+#define STAT_RESOLVE_RETRIES 4 //template scans beyond the first for a single instruction
+#define STAT_EXCEPTIONS      5 //exceptions thrown while resolving instructions
+#define STAT_BYTES_EMITTED   6 //bytes of assembled output
+#define STAT_CACHE_LOOKUPS   7 //lines looked for among those already encoded
+#define STAT_CACHE_HITS      8 //lines found there, which are not resolved again
+#define STAT_COUNT           9
+
+#define PHASE_PREPROCESS 0 //preprocessing of the main file and everything it injects
+#define PHASE_ASSEMBLE   1 //assembler::run, template lookups included
+#define PHASE_LOOKUP     2 //time spent scanning the template file, added up over every thread that encodes
+#define PHASE_OUTPUT     3 //writing or displaying results
+#define PHASE_ENCODE     4 //the parallel pass that encodes instructions, as it is seen from the calling thread
+#define PHASE_COUNT      5
+
+#include <atomic>
+#include <string>
+#include <vector>
+using namespace std;
+
+namespace stats
+{
+    extern bool enabled;                                //nothing is collected unless this is set
+    extern atomic<long long> counters[STAT_COUNT];     //counted from every thread that assembles
+    
+    inline void count(int counter, long long amount = 1) { if (enabled) counters[counter] += amount; }
+    long long now_us();                                 //microseconds on a monotonic clock
+    void add_phase(int phase, long long start_us);      //adds time since start to a phase
+    void add_file(string file, long long start_us);     //records the time spent preprocessing one file
+    double seconds(int phase);                          //total time spent in a phase so far
+    bool write_json(string file);                       //totals, counters, and per file times
+    bool write_trace(string file);                      //chrome://tracing and Perfetto trace events
+}
+
+//times a phase from construction to destruction
+class stat_timer
+{
+    int phase;
+    long long start;
+    
+    public:
+        stat_timer(int which) : phase(which), start(stats::enabled ? stats::now_us() : 0) {}
+        ~stat_timer() { if (stats::enabled) stats::add_phase(phase, start); }
+};
+
+#endif
@@ -0,0 +1,457 @@
+/*==============================================================================================
+    
+    tape.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "tape.hpp"
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+//lines starting with @ mark an address, @name in an argument is replaced by it, relative for jr
+static const char* fast_loader[] = {
+    "call 743",          //SET-FAST, the display would upset the timing
+    "push ix",
+    "in a,254",
+    "ld c,a",            //bit 7 of c follows the level on the tape input
+    "@pilot",
+    "ld d,64",
+    "@count",
+    "ld b,0",
+    "call @cycle",
+    "jr c,@pilot",       //needs 64 short cycles in a row before looking for the sync
+    "dec d",
+    "jr nz,@count",
+    "@sync",
+    "ld b,0",
+    "call @half",
+    "jr nc,@sync",       //the sync is a single long half, the first bit starts on its far edge
+    "xor a",
+    "ex af,af'",         //a' keeps the checksum
+    "ld ix,@table",
+    "@block",
+    "ld l,(ix+0)",
+    "ld h,(ix+1)",
+    "ld e,(ix+2)",
+    "ld d,(ix+3)",
+    "ld a,d",
+    "or e",
+    "ld b,9",            //counts start ahead by the time taken away from them, here between blocks
+    "jr z,@check",       //a block with no length ends the table
+    "@byte",
+    "ld (hl),1",         //marker bit, it falls out into carry once eight bits are in
+    "@bit",
+    "call @cycle",
+    "rl (hl)",
+    "ld b,3",            //between bits
+    "jr nc,@bit",
+    "ex af,af'",
+    "xor (hl)",
+    "ex af,af'",
+    "inc hl",
+    "dec de",
+    "ld a,d",
+    "or e",
+    "ld b,5",            //between bytes
+    "jr nz,@byte",
+    "inc ix",
+    "inc ix",
+    "inc ix",
+    "inc ix",
+    "jr @block",
+    "@check",
+    "ld hl,@scratch",
+    "ld (hl),1",
+    "@sum",
+    "call @cycle",
+    "rl (hl)",
+    "ld b,3",
+    "jr nc,@sum",
+    "ex af,af'",
+    "xor (hl)",          //zero when the checksum matches
+    "pop ix",
+    "push af",
+    "call 519",          //SLOW/FAST, back to the mode the program was saved in
+    "pop af",
+    "ret nz",            //a bad load goes back to BASIC without running anything
+    "jp @entry",
+    "@cycle",            //counts two edges on from b, carry is set when it was a long cycle
+    "call @half",
+    "@half",             //counts until the next edge, 38 T-states a count
+    "inc b",
+    "in a,254",
+    "xor c",
+    "and 128",
+    "jr z,@half",
+    "ld a,c",
+    "cpl",
+    "ld c,a",
+    "ld a,@threshold",
+    "cp b",
+    "ret"
+};
+
+tape::tape(assembler* program, assembler* as, string program_name, bool fast)
+{
+    ostringstream raw;
+    ostringstream p_out;
+    vector<int> starts;
+    vector<int> lengths;
+    vector<uchar> rem;
+    vector<uchar> run;
+    vector<uchar> loader;
+    snapshot shell;
+    int rem_length = 0;
+    int entry;
+    int usr;
+    
+    errors_exist = false;
+    level = TAPE_LOW;
+    time_us = 0;
+    samples = 0;
+    
+    for (int i = 0; i < program_name.length(); i++)
+    {
+        if (isalnum(program_name[i]))
+            name += (char)snapshot::character(program_name[i]);
+    }
+    
+    if (name == "")
+    {
+        string fallback = "SIASM";
+        
+        for (int i = 0; i < fallback.length(); i++)
+            name += (char)snapshot::character(fallback[i]);
+    }
+    
+    name[name.length()-1] |= 0x80; //marks the end of the name
+    
+    program->write_image(raw);
+    image = raw.str();
+    image_start = program->image_address();
+    program->populated_ranges(starts, lengths);
+    
+    if (starts.size() == 0)
+    {
+        cout << "There is nothing to put on tape." << endl;
+        errors_exist = true;
+        return;
+    }
+    
+    //code at 16514 goes in the REM on the first line, the ROM loads it along with the program
+    if (starts[0] == REM_ADDRESS)
+        rem_length = lengths[0];
+    
+    for (int i = (rem_length > 0) ? 1 : 0; i < starts.size(); i++)
+    {
+        tape_block block = { starts[i], lengths[i] };
+        fast_blocks.push_back(block);
+    }
+    
+    if (!fast && fast_blocks.size() > 0)
+    {
+        cout << "Only code assembled at " << REM_ADDRESS << " goes in the REM line, the range at "
+             << fast_blocks[0].address << " needs --fast-load." << endl;
+        errors_exist = true;
+        return;
+    }
+    
+    entry = (rem_length > 0) ? REM_ADDRESS : fast_blocks[0].address;
+    usr = entry;
+    rem.push_back(ZX_REM);
+    rem.insert(rem.end(), image.begin(), image.begin() + rem_length);
+    
+    //the loader sits in the REM right after the code and is what the BASIC program runs
+    if (fast_blocks.size() > 0)
+    {
+        usr = REM_ADDRESS + rem_length;
+        
+        if (!build_loader(as, usr, entry, loader))
+        {
+            cout << "The fast loader could not be assembled." << endl;
+            errors_exist = true;
+            return;
+        }
+        
+        rem.insert(rem.end(), loader.begin(), loader.end());
+    }
+    
+    run.push_back(ZX_RAND);
+    run.push_back(ZX_USR);
+    snapshot::append_number(run, usr);
+    shell.add_line(1, rem);
+    shell.auto_run(shell.add_line(2, run));
+    
+    for (int i = 0; i < fast_blocks.size(); i++)
+    {
+        if (fast_blocks[i].address < shell.end_address())
+        {
+            cout << "The range at " << fast_blocks[i].address << " overlaps the BASIC program that loads it, which ends at "
+                 << shell.end_address() << "." << endl;
+            errors_exist = true;
+        }
+    }
+    
+    shell.write_p(p_out);
+    p_data = p_out.str();
+}
+
+bool tape::build_loader(assembler* as, int origin, int entry, vector<uchar> &code)
+{
+    vector<string> marks;
+    vector<int> addresses;
+    vector<int> bytes;
+    int address = origin;
+    
+    marks.push_back("entry");
+    addresses.push_back(entry);
+    marks.push_back("threshold");
+    addresses.push_back(FAST_THRESHOLD);
+    
+    //the first pass finds every mark, the second fills them in
+    for (int pass = 0; pass < 2; pass++)
+    {
+        code.clear();
+        address = origin;
+        
+        for (int i = 0; i < sizeof(fast_loader) / sizeof(fast_loader[0]); i++)
+        {
+            string line = fast_loader[i];
+            size_t at = line.find('@');
+            
+            if (at == 0)
+            {
+                if (pass == 0)
+                {
+                    marks.push_back(line.substr(1));
+                    addresses.push_back(address);
+                }
+                
+                continue;
+            }
+            
+            if (at != string::npos)
+            {
+                string mark = line.substr(at + 1);
+                int value = 0;
+                
+                for (int j = 0; pass > 0 && j < marks.size(); j++)
+                {
+                    if (marks[j] == mark)
+                        value = (line.compare(0, 2, "jr") == 0) ? addresses[j] - (address + 2) : addresses[j];
+                }
+                
+                line.erase(at);
+                bs_util::append_int(line, value);
+            }
+            
+            if (!as->assemble_line(line, bytes))
+                return false;
+            
+            for (int j = 0; j < bytes.size(); j++)
+                code.push_back(bytes[j] & 0xFF);
+            
+            address += bytes.size();
+        }
+        
+        if (pass == 0)
+        {
+            marks.push_back("scratch");
+            addresses.push_back(address);
+            marks.push_back("table");
+            addresses.push_back(address + 1);
+        }
+    }
+    
+    code.push_back(0); //scratch byte the checksum is read into
+    
+    for (int i = 0; i < fast_blocks.size(); i++)
+    {
+        code.push_back(bs_util::num_get_lsb(fast_blocks[i].address));
+        code.push_back(bs_util::num_get_msb(fast_blocks[i].address));
+        code.push_back(bs_util::num_get_lsb(fast_blocks[i].length));
+        code.push_back(bs_util::num_get_msb(fast_blocks[i].length));
+    }
+    
+    code.insert(code.end(), 4, 0);
+    return true;
+}
+
+int tape::fast_bytes()
+{
+    int total = 0;
+    
+    for (int i = 0; i < fast_blocks.size(); i++)
+        total += fast_blocks[i].length;
+    
+    return total;
+}
+
+bool tape::write_p(string file)
+{
+    ofstream outstream;
+    outstream.open(file.c_str(), ios::binary|ios::out);
+    
+    if (!outstream.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    outstream.write(p_data.data(), p_data.length());
+    outstream.close();
+    return true;
+}
+
+bool tape::write_wav(string file)
+{
+    const int HEADER_SIZE = 44;
+    int checksum = 0;
+    
+    stream_wav.open(file.c_str(), ios::binary|ios::out);
+    
+    if (!stream_wav.is_open())
+    {
+        cout << file << " could not be opened to write!" << endl;
+        return false;
+    }
+    
+    //the header is written again at the end once the number of samples is known
+    stream_wav << string(HEADER_SIZE, '\0');
+    buffer.clear();
+    buffer.reserve(TAPE_BUFFER_SIZE);
+    level = TAPE_LOW;
+    time_us = 0;
+    samples = 0;
+    
+    hold(TAPE_LEAD_MS * 1000LL);
+    
+    for (int i = 0; i < name.length(); i++)
+        rom_byte((uchar)name[i]);
+    
+    for (int i = 0; i < p_data.length(); i++)
+        rom_byte((uchar)p_data[i]);
+    
+    if (fast_blocks.size() > 0)
+    {
+        hold(FAST_GAP_MS * 1000LL);
+        
+        for (long long pilot = 0; pilot < FAST_PILOT_MS * 1000LL; pilot += 2 * FAST_SHORT_US)
+        {
+            flip(FAST_SHORT_US);
+            flip(FAST_SHORT_US);
+        }
+        
+        flip(FAST_SYNC_US);
+        
+        for (int i = 0; i < fast_blocks.size(); i++)
+        {
+            for (int j = 0; j < fast_blocks[i].length; j++)
+            {
+                int value = (uchar)image[fast_blocks[i].address - image_start + j];
+                fast_byte(value);
+                checksum ^= value;
+            }
+        }
+        
+        fast_byte(checksum);
+    }
+    
+    hold(FAST_TAIL_MS * 1000LL);
+    flush();
+    
+    //RIFF header for unsigned 8-bit mono
+    long long data_size = samples;
+    uchar header[HEADER_SIZE] = { 'R','I','F','F', 0,0,0,0, 'W','A','V','E', 'f','m','t',' ', 16,0,0,0, 1,0, 1,0,
+                                  0,0,0,0, 0,0,0,0, 1,0, 8,0, 'd','a','t','a', 0,0,0,0 };
+    
+    for (int i = 0; i < 4; i++)
+    {
+        header[4+i] = ((data_size + HEADER_SIZE - 8) >> (8*i)) & 0xFF;
+        header[24+i] = (TAPE_SAMPLE_RATE >> (8*i)) & 0xFF;
+        header[28+i] = (TAPE_SAMPLE_RATE >> (8*i)) & 0xFF; //one byte a sample
+        header[40+i] = (data_size >> (8*i)) & 0xFF;
+    }
+    
+    stream_wav.seekp(0);
+    stream_wav.write((const char*)header, HEADER_SIZE);
+    stream_wav.close();
+    return true;
+}
+
+void tape::hold(long long us)
+{
+    time_us += us;
+    long long target = time_us * TAPE_SAMPLE_RATE / 1000000;
+    
+    //samples are only ever counted from the total time, so rounding never builds up
+    while (samples < target)
+    {
+        buffer.push_back(level);
+        samples++;
+        
+        if (buffer.size() == TAPE_BUFFER_SIZE)
+            flush();
+    }
+}
+
+void tape::flip(long long us)
+{
+    hold(us);
+    level = (level == TAPE_HIGH) ? TAPE_LOW : TAPE_HIGH;
+}
+
+void tape::rom_byte(int value)
+{
+    //most significant bit first, each a burst of pulses followed by silence
+    for (int bit = 7; bit >= 0; bit--)
+    {
+        int pulses = ((value >> bit) & 1) ? ROM_ONE_PULSES : ROM_ZERO_PULSES;
+        
+        for (int i = 0; i < pulses; i++)
+        {
+            level = TAPE_HIGH;
+            hold(ROM_PULSE_US);
+            level = TAPE_LOW;
+            hold(ROM_PULSE_US);
+        }
+        
+        hold(ROM_GAP_US);
+    }
+}
+
+void tape::fast_byte(int value)
+{
+    //most significant bit first, each a whole cycle whose length gives its value
+    for (int bit = 7; bit >= 0; bit--)
+    {
+        int half = ((value >> bit) & 1) ? FAST_LONG_US : FAST_SHORT_US;
+        flip(half);
+        flip(half);
+    }
+}
+
+void tape::flush()
+{
+    if (buffer.size() > 0)
+        stream_wav.write((const char*)&buffer[0], buffer.size());
+    
+    buffer.clear();
+}
@@ -0,0 +1,98 @@
+/*==============================================================================================
+    
+    tape.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Tape
+    10/19/26 - B.D.S.
+    Purpose: Turns an assembled image into a ZX81 program and streams it out as tape audio.
+    
+==============================================================================================*/
+
+#ifndef _TAPE_HPP
+#define _TAPE_HPP
+
+#define TAPE_SAMPLE_RATE 44100
+#define TAPE_HIGH        224   //unsigned 8-bit sample values of the square wave
+#define TAPE_LOW         32
+#define TAPE_BUFFER_SIZE 65536 //samples held before they are written out
+#define TAPE_LEAD_MS     1000  //silence before the name
+
+#define ROM_PULSE_US     150   //each half of a pulse the ROM counts
+#define ROM_GAP_US       1300  //silence that ends every bit
+#define ROM_ZERO_PULSES  4
+#define ROM_ONE_PULSES   9
+
+#define FAST_GAP_MS      200   //time for the ROM to finish loading and start the loader
+#define FAST_PILOT_MS    1000  //short cycles the loader locks on to
+#define FAST_SHORT_US    113   //each half of a zero, about five samples
+#define FAST_LONG_US     227   //each half of a one
+#define FAST_SYNC_US     454   //single half that ends the pilot and lines the loader up with the first bit
+#define FAST_THRESHOLD   27    //loader counts of 38 T-states above this are a one
+#define FAST_TAIL_MS     100
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "assembler.hpp"
+#include "bs_util.hpp"
+#include "snapshot.hpp"
+using namespace std;
+
+//a range of the image that the fast loader brings in after the ROM has loaded the BASIC program
+struct tape_block
+{
+    int address;
+    int length;
+};
+
+class tape
+{
+    string name;                    //program name in ZX81 characters, the last one with its top bit set
+    string image;                   //assembled image from image_start, zero filled between ranges
+    int image_start;
+    string p_data;                  //everything the ROM loads, from VERSN to E_LINE
+    vector<tape_block> fast_blocks;
+    
+    ofstream stream_wav;
+    vector<uchar> buffer;
+    int level;                      //sample value being written
+    long long time_us;              //length of the tape so far
+    long long samples;              //samples written so far, always time_us in samples rounded down
+    
+    void hold(long long us);        //keeps the current level until time_us has moved on by us
+    void flip(long long us);        //holds the level for us then swaps it, one half of a fast cycle
+    void rom_byte(int value);
+    void fast_byte(int value);
+    void flush();
+    
+    //assembles the fast loader at origin with every @name in its lines replaced by its address
+    bool build_loader(assembler* as, int origin, int entry, vector<uchar> &code);
+    
+    public:
+        bool errors_exist;
+        tape(assembler* program, assembler* as, string program_name, bool fast);
+        bool write_p(string file);   //the program as a .P file
+        bool write_wav(string file); //the program as tape audio, fast blocks after it when there are any
+        double seconds() { return (double)time_us / 1e6; } //length of the last tape written
+        int  fast_bytes();           //bytes left to the fast loader
+};
+
+#endif
@@ -0,0 +1,224 @@
+/*==============================================================================================
+    
+    token_ir.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "token_ir.hpp"
+#include "lexer.hpp"
+#include <cctype>
+#include <climits>
+
+//spelled in the order of the NAME_ ids
+static const char* fixed_names[NAME_FIXED_COUNT] = {
+    "org", "section", "page", "nopagecross", "assert_cycles", "assert_size",
+    "db", "dw", "ds", "incbin", "dbtable", "dwtable", "align"
+};
+
+//a letter followed by letters, digits, and underscores, as registers, conditions, labels, and constants are, or af'
+static bool is_word(const char* start, int length)
+{
+    if (length < 1 || !isalpha((uchar)start[0]))
+        return false;
+    
+    for (int i = 1; i < length; i++)
+    {
+        if (!isalnum((uchar)start[i]) && start[i] != '_' && !(start[i] == '\'' && i == length - 1))
+            return false;
+    }
+    
+    return true;
+}
+
+//a number only counts when append_int would spell it the same way, so the line can be spelled back as it was
+static bool whole_number(const char* start, int length, int &value)
+{
+    long long number = 0;
+    int at = (length > 0 && start[0] == '-') ? 1 : 0;
+    
+    if (at == length || length - at > 10 || (start[at] == '0' && (length - at > 1 || at == 1)))
+        return false;
+    
+    for (int i = at; i < length; i++)
+    {
+        if (!isdigit((uchar)start[i]))
+            return false;
+        
+        number = number * 10 + (start[i] - '0');
+    }
+    
+    number = at ? -number : number;
+    
+    if (number < INT_MIN || number > INT_MAX)
+        return false;
+    
+    value = (int)number;
+    return true;
+}
+
+token_ir::token_ir()
+{
+    for (int i = 0; i < NAME_FIXED_COUNT; i++)
+        name_id(fixed_names[i]);
+}
+
+int token_ir::operand(const char* start, int length, int &value)
+{
+    bool pointer = (length >= 2 && start[0] == '(' && start[length-1] == ')');
+    const char* inner = pointer ? start + 1 : start;
+    int inner_length = pointer ? length - 2 : length;
+    
+    if (length == 0)
+        return OPERAND_NONE;
+    
+    if (is_word(inner, inner_length))
+    {
+        value = name_id(string(inner, inner_length));
+        return OPERAND_NAME + (pointer ? OPERAND_POINTER : 0);
+    }
+    
+    if (whole_number(inner, inner_length, value))
+        return OPERAND_NUMBER + (pointer ? OPERAND_POINTER : 0);
+    
+    //(ix+d) and (iy-d), with no spaces and d written as a plain number
+    if (pointer && inner_length > 3 && inner[0] == 'i' && (inner[1] == 'x' || inner[1] == 'y') && (inner[2] == '+' || inner[2] == '-')
+        && inner[3] != '-' && whole_number(inner + 3, inner_length - 3, value) && !(inner[2] == '-' && value == 0))
+    {
+        value = (inner[2] == '-') ? -value : value;
+        return (inner[1] == 'x') ? OPERAND_IX_DIS : OPERAND_IY_DIS;
+    }
+    
+    value = text.length();
+    text.append(start, length);
+    text += '\0';
+    return OPERAND_TEXT;
+}
+
+void token_ir::add_line(const char* line, int length, int file, int source_line)
+{
+    span m, a1, a2;
+    int value1 = 0;
+    int value2 = 0;
+    
+    lexer::split_instruction(line, 0, length, m, a1, a2);
+    mnemonics.push_back((length > 0) ? name_id(string(line + m.start, m.length)) : -1);
+    kinds1.push_back(operand(line + a1.start, a1.length, value1));
+    kinds2.push_back(operand(line + a2.start, a2.length, value2));
+    values1.push_back(value1);
+    values2.push_back(value2);
+    files.push_back(file);
+    source_lines.push_back(source_line);
+}
+
+void token_ir::copy_line(int line)
+{
+    //operands kept as text point into text, which lines are only ever added to
+    mnemonics.push_back(mnemonics[line]);
+    kinds1.push_back(kinds1[line]);
+    kinds2.push_back(kinds2[line]);
+    values1.push_back(values1[line]);
+    values2.push_back(values2[line]);
+    files.push_back(files[line]);
+    source_lines.push_back(source_lines[line]);
+}
+
+void token_ir::clear()
+{
+    mnemonics.clear();
+    kinds1.clear();
+    kinds2.clear();
+    values1.clear();
+    values2.clear();
+    files.clear();
+    source_lines.clear();
+    text.clear();
+}
+
+int token_ir::name_id(const string &name)
+{
+    unordered_map<string, int>::const_iterator found = name_ids.find(name);
+    
+    if (found != name_ids.end())
+        return found->second;
+    
+    names.push_back(name);
+    name_ids[name] = names.size() - 1;
+    return names.size() - 1;
+}
+
+int token_ir::file_id(const string &file)
+{
+    for (int i = 0; i < file_names.size(); i++)
+    {
+        if (file_names[i] == file)
+            return i;
+    }
+    
+    file_names.push_back(file);
+    return file_names.size() - 1;
+}
+
+string token_ir::spell_operand(int kind, int value) const
+{
+    string spelled;
+    
+    switch (kind & ~OPERAND_POINTER)
+    {
+        case OPERAND_NAME:
+            spelled = names[value];
+        break;
+        
+        case OPERAND_NUMBER:
+            bs_util::append_int(spelled, value);
+        break;
+        
+        case OPERAND_IX_DIS:
+        case OPERAND_IY_DIS:
+            spelled = (kind == OPERAND_IX_DIS) ? "(ix" : "(iy";
+            spelled += (value < 0) ? '-' : '+';
+            bs_util::append_int(spelled, (value < 0) ? -value : value);
+            spelled += ')';
+        break;
+        
+        case OPERAND_TEXT:
+            spelled = text.c_str() + value;
+        break;
+    }
+    
+    return (kind & OPERAND_POINTER) ? "(" + spelled + ")" : spelled;
+}
+
+void token_ir::spell(int line, string &mnem, string &arg1, string &arg2) const
+{
+    mnem = (mnemonics[line] >= 0) ? names[mnemonics[line]] : "";
+    arg1 = spell_operand(kinds1[line], values1[line]);
+    arg2 = spell_operand(kinds2[line], values2[line]);
+}
+
+string token_ir::spell_line(int line) const
+{
+    string mnem, arg1, arg2;
+    
+    spell(line, mnem, arg1, arg2);
+    
+    if (arg2 != "")
+        return mnem + ' ' + arg1 + ',' + arg2;
+    
+    return (arg1 != "") ? mnem + ' ' + arg1 : mnem;
+}
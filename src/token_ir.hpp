@@ -0,0 +1,93 @@
+/*==============================================================================================
+    
+    token_ir.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    Token IR
+    10/19/26 - B.D.S.
+    Purpose: Holds the lines of a program as mnemonic and name ids, operand kinds, and values, lexed once for every pass.
+    
+==============================================================================================*/
+
+
+#ifndef _TOKEN_IR_HPP
+#define _TOKEN_IR_HPP
+
+#define OPERAND_NONE     0
+#define OPERAND_NAME     1 //a register, condition, symbol, or constant, the value is its name id
+#define OPERAND_NUMBER   2 //a whole number written the way append_int would write it, the value is the number
+#define OPERAND_IX_DIS   3 //(ix+d) or (ix-d), the value is d
+#define OPERAND_IY_DIS   4
+#define OPERAND_TEXT     5 //anything else, such as the rest of a list, the value is where it starts in text
+#define OPERAND_POINTER  8 //added to the kind of a name or number written in brackets
+
+#define NAME_ORG         0 //mnemonics that are not instructions have the same ids in every program
+#define NAME_SECTION     1
+#define NAME_PAGE        2
+#define NAME_NOPAGECROSS 3
+#define NAME_ASSERT_CYCLES 4
+#define NAME_ASSERT_SIZE 5 //the last directive
+#define NAME_DB          6
+#define NAME_DW          7
+#define NAME_DS          8
+#define NAME_INCBIN      9
+#define NAME_DBTABLE     10
+#define NAME_DWTABLE     11
+#define NAME_ALIGN       12 //the last kind of data
+#define NAME_FIXED_COUNT 13
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bs_util.hpp"
+using namespace std;
+
+//the lines of a program as a structure of arrays, one entry in each for every line
+class token_ir
+{
+    unordered_map<string, int> name_ids;
+    
+    int operand(const char* start, int length, int &value); //kind of an operand, and its value
+    
+    public:
+        vector<int> mnemonics;      //name id of each mnemonic, -1 for an empty line
+        vector<uchar> kinds1;       //kinds of the first and second operands
+        vector<uchar> kinds2;
+        vector<int> values1;
+        vector<int> values2;
+        vector<int> files;          //where each line came from, as an index into file_names, -1 when it is not known
+        vector<int> source_lines;   //line of that file, the last line of a rept block for its lines
+        vector<string> names;       //every mnemonic and name by id
+        vector<string> file_names;
+        string text;                //operands kept as text, each followed by a zero
+        
+        token_ir();
+        void add_line(const char* line, int length, int file, int source_line); //lexes a line onto the end
+        void copy_line(int line);                    //adds a line already lexed onto the end again
+        void clear();                                //drops the lines, names keep their ids
+        int  size() const { return mnemonics.size(); }
+        int  name_id(const string &name);            //id of a name, given a new one the first time it is seen
+        int  file_id(const string &file);
+        string spell_operand(int kind, int value) const; //an operand as it was written
+        void spell(int line, string &mnem, string &arg1, string &arg2) const; //the parts of a line as the lexer splits them
+        string spell_line(int line) const;           //the whole line, which lexes back into the same tokens
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*==============================================================================================
+    
+    watcher.cpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================*/
+
+#include "watcher.hpp"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+watcher::watcher()
+{
+    errors_exist = false;
+    notify_fd = -1;
+    
+#if defined(__linux__)
+    notify_fd = inotify_init();
+    
+    if (notify_fd < 0)
+        cout << "inotify is not available, checking files every " << WATCH_POLL_MS << " ms instead." << endl;
+#endif
+}
+
+watcher::~watcher()
+{
+#if defined(__linux__)
+    if (notify_fd >= 0)
+        close(notify_fd);
+#endif
+}
+
+void watcher::watch(const vector<string> &paths)
+{
+    files = paths;
+    folders.clear();
+    names.clear();
+    stamps.clear();
+    
+    for (int i = 0; i < files.size(); i++)
+    {
+        size_t slash = files[i].find_last_of("/\\");
+        folders.push_back((slash == string::npos) ? "." : files[i].substr(0, (slash == 0) ? 1 : slash));
+        names.push_back((slash == string::npos) ? files[i] : files[i].substr(slash + 1));
+        stamps.push_back(stamp(files[i]));
+        
+#if defined(__linux__)
+        //folders stay watched once added, a file that moves back into one is still noticed
+        if (notify_fd >= 0 && find(watch_folders.begin(), watch_folders.end(), folders[i]) == watch_folders.end())
+        {
+            int id = inotify_add_watch(notify_fd, folders[i].c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            
+            if (id < 0)
+            {
+                cout << folders[i] << " could not be watched!" << endl;
+                errors_exist = true;
+            }
+            
+            watch_ids.push_back(id);
+            watch_folders.push_back(folders[i]);
+        }
+#endif
+    }
+}
+
+vector<string> watcher::wait()
+{
+    vector<string> changed;
+    
+    while (changed.size() == 0 && !errors_exist)
+    {
+#if defined(__linux__)
+        if (notify_fd >= 0)
+        {
+            char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            struct pollfd pending = { notify_fd, POLLIN, 0 };
+            int timeout = -1; //wait as long as it takes for the first event, then only take what is already queued
+            
+            while (poll(&pending, 1, timeout) > 0)
+            {
+                int length = read(notify_fd, events, sizeof(events));
+                timeout = 0;
+                
+                if (length <= 0)
+                {
+                    cout << "Changes to the watched folders could not be read!" << endl;
+                    errors_exist = true;
+                    break;
+                }
+                
+                for (int at = 0; at < length; )
+                {
+                    struct inotify_event* ev = (struct inotify_event*)(events + at);
+                    at += sizeof(struct inotify_event) + ev->len;
+                    
+                    if (ev->len == 0)
+                        continue;
+                    
+                    for (int i = 0; i < files.size(); i++)
+                    {
+                        int folder = find(watch_folders.begin(), watch_folders.end(), folders[i]) - watch_folders.begin();
+                        
+                        if (watch_ids[folder] == ev->wd && names[i] == ev->name
+                            && find(changed.begin(), changed.end(), files[i]) == changed.end())
+                            changed.push_back(files[i]);
+                    }
+                }
+            }
+            
+            continue;
+        }
+#endif
+
+#if defined(_WIN32)
+        Sleep(WATCH_POLL_MS);
+#else
+        usleep(WATCH_POLL_MS * 1000);
+#endif
+        
+        for (int i = 0; i < files.size(); i++)
+        {
+            long long now = stamp(files[i]);
+            
+            if (now != stamps[i])
+            {
+                stamps[i] = now;
+                changed.push_back(files[i]);
+            }
+        }
+    }
+    
+    return changed;
+}
+
+long long watcher::stamp(string file)
+{
+    struct stat info;
+    
+    if (stat(file.c_str(), &info) != 0)
+        return 0;
+    
+    return (long long)info.st_mtime * 1000003 + info.st_size;
+}
@@ -0,0 +1,58 @@
+/*==============================================================================================
+    
+    watcher.hpp
+    Copyright 2019-2021 Buster Schrader
+    
+    This file is part of SIASM.
+    
+    SIASM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+    
+    SIASM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    
+    You should have received a copy of the GNU General Public License
+    along with SIASM.  If not, see <https://www.gnu.org/licenses/>.
+    
+==============================================================================================
+
+    File Watcher
+    10/19/26 - B.D.S.
+    Purpose: Waits for source files to change, with inotify on Linux and by polling elsewhere.
+    
+==============================================================================================*/
+
+#ifndef _WATCHER_HPP
+#define _WATCHER_HPP
+
+#define WATCH_POLL_MS 100 //time between checks where inotify is not available
+
+#include <string>
+#include <vector>
+using namespace std;
+
+class watcher
+{
+    vector<string> files;       //paths as they were given
+    vector<string> folders;     //folder each file is in, watched rather than the file since editors often replace files
+    vector<string> names;       //name of each file within its folder
+    vector<long long> stamps;   //modification time and size of each file when polling
+    int notify_fd;              //inotify instance, -1 when polling
+    vector<int> watch_ids;      //one inotify watch for each folder
+    vector<string> watch_folders;
+    
+    long long stamp(string file); //changes whenever the file is written, zero if it is missing
+    
+    public:
+        bool errors_exist;
+        watcher();
+        ~watcher();
+        void watch(const vector<string> &paths); //replaces the files being watched
+        vector<string> wait();                   //blocks until at least one watched file changes and returns them
+};
+
+#endif
@@ -0,0 +1,142 @@
+#!/bin/sh
+#assembles the programs in fixtures and checks what comes out, run from test by make check
+#name.bda must give the same bytes as name.expect.bda, and name_fail.bda must not assemble
+#a first line of //check: options assembles name.bda with those options, name.expect.bda never takes any
+#and an image made with --pack is unpacked before it is compared, while OUT in them names the file that is,
+#for options such as --p that write a file of their own
+
+work=check_work
+failed=0
+passed=0
+
+mkdir -p $work
+
+pass() {
+    passed=$((passed + 1))
+}
+
+fail() {
+    echo "FAILED: $1"
+    failed=$((failed + 1))
+}
+
+assemble() {
+    ./siasm "$@" > $work/last.log 2>&1
+}
+
+#replaces a --pack image with what the depacker would unpack: after its 45 bytes, control bytes 0 to 127 come
+#before one more literal byte than they are, 128 to 254 copy three more bytes than they are above 127 from the
+#negative distance in the next word, and 255 ends the data
+unpack() {
+    printf "$(od -An -v -tu1 $1 | awk '
+        { for (i = 1; i <= NF; i++) b[n++] = $i }
+        END {
+            for (p = 45; p < n && b[p] != 255; ) {
+                c = b[p++]
+
+                if (c < 128)
+                    for (k = 0; k <= c; k++) o[m++] = b[p++]
+                else {
+                    d = 65536 - b[p] - b[p + 1] * 256
+                    p += 2
+
+                    for (k = 0; k < c - 125; k++) { o[m] = o[m - d]; m++ }
+                }
+            }
+
+            for (k = 0; k < m; k++) printf "\\%o", o[k]
+        }')" > $1.unpacked && mv $1.unpacked $1
+}
+
+for expect in fixtures/*.expect.bda; do
+    [ -f $expect ] || continue
+    name=$(basename $expect .expect.bda)
+    options=$(sed -n '1s|^//check: ||p' fixtures/$name.bda)
+    image=$work/$name.bin
+
+    case " $options " in
+        *" OUT "*) options=$(echo " $options " | sed "s| OUT | $work/$name.bin |"); image=$work/$name.image ;;
+    esac
+
+    if assemble $options -o $image fixtures/$name.bda; then
+        case " $options " in
+            *" --pack "*) unpack $work/$name.bin ;;
+        esac
+    fi
+
+    if [ -f $work/$name.bin ] && assemble -o $work/$name.expect.bin $expect \
+       && cmp -s $work/$name.bin $work/$name.expect.bin; then
+        pass
+    else
+        fail "$name.bda does not give the bytes of $name.expect.bda"
+    fi
+done
+
+for source in fixtures/*_fail.bda; do
+    [ -f $source ] || continue
+    name=$(basename $source .bda)
+
+    if assemble -o $work/$name.bin $source || [ -f $work/$name.bin ]; then
+        fail "$name.bda assembled"
+    else
+        pass
+    fi
+done
+
+#the listing -d writes for an image is the expect file itself, which the loop above assembled back to the same bytes
+if assemble -o $work/disasm.bin fixtures/disasm.bda && assemble -d $work/disasm.bin -o $work/disasm.lst \
+   && cmp -s $work/disasm.lst fixtures/disasm.expect.bda; then
+    pass
+else
+    fail "disassembling disasm.bda does not give disasm.expect.bda"
+fi
+
+#objects joined by siasm-link give the same image as the same files injected into one program
+if assemble -c -o $work/link_main.obj fixtures/link_main.bda && assemble -c -o $work/link_lib.obj fixtures/link_lib.bda \
+   && ./siasm-link -o $work/linked.bin $work/link_main.obj $work/link_lib.obj > $work/last.log 2>&1 \
+   && assemble -o $work/injected.bin fixtures/link_all.bda && cmp -s $work/linked.bin $work/injected.bin; then
+    pass
+else
+    fail "linking link_main.bda and link_lib.bda does not give the bytes of link_all.bda"
+fi
+
+#a patch of the blocks that changed, applied to the old image, gives the new one
+applied=no
+
+if assemble -o $work/delta_old.bin fixtures/delta_old.bda \
+   && assemble -o $work/delta_new.bin --delta $work/delta_old.bin $work/delta.patch fixtures/delta_new.bda; then
+    cp $work/delta_old.bin $work/delta_applied.bin
+    set -- $(od -An -v -tu1 $work/delta.patch)
+    applied=yes
+
+    while [ $# -ge 4 ]; do
+        address=$(($1 + $2 * 256 - 16514))
+        length=$(($3 + $4 * 256))
+        shift 4
+
+        if [ $length -eq 0 ]; then
+            break
+        fi
+
+        bytes=""
+
+        while [ $length -gt 0 ] && [ $# -gt 0 ]; do
+            bytes="$bytes\\$(printf %o $1)"
+            length=$((length - 1))
+            shift
+        done
+
+        printf "$bytes" | dd of=$work/delta_applied.bin bs=1 seek=$address conv=notrunc 2> /dev/null
+    done
+fi
+
+if [ $applied = yes ] && cmp -s $work/delta_applied.bin $work/delta_new.bin; then
+    pass
+else
+    fail "delta.patch applied to delta_old.bda does not give the bytes of delta_new.bda"
+fi
+
+rm -rf $work
+
+echo "$passed checks passed, $failed failed."
+[ $failed -eq 0 ]